@@ -0,0 +1,83 @@
+/*
+    Copyright (c) 2024 BB-301 <fw3dg3@gmail.com> [Official repository](https://github.com/BB-301/c-generic-doubly-linked-list)
+
+    Permission is hereby granted, free of charge, to any person
+    obtaining a copy of this software and associated documentation
+    files (the “Software”), to deal in the Software without restriction,
+    including without limitation the rights to use, copy, modify, merge,
+    publish, distribute, sublicense, and/or sell copies of the Software,
+    and to permit persons to whom the Software is furnished to do so,
+    subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+    THE SOFTWARE.
+*/
+
+/*
+    =============================
+    Example: Push/shift benchmark
+    =============================
+
+    This example measures the cost of the library's hot paths by using
+    a `g2l_t` as a FIFO queue: a number of elements are pushed and then
+    shifted out, and the average cost of one push + shift pair (plus a
+    `g2l_size` call) is reported.
+
+    Running it with `make example_push_shift_benchmark` and then with
+    `make BUILD_PROFILE=release example_push_shift_benchmark` shows the
+    difference between the default (i.e., debug) build and the release
+    build, which is also run in header-only mode (i.e., `G2L_HEADER_ONLY`).
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "g2l.h"
+
+#define NUMBER_OF_ITEMS (1000000)
+#define NUMBER_OF_ROUNDS (10)
+
+struct my_data_type
+{
+    int value_1;
+    int value_2;
+};
+
+int main(void)
+{
+    g2l_t *queue = g2l_create(sizeof(struct my_data_type), true);
+    struct my_data_type tmp = {0, 0};
+    long long checksum = 0;
+
+    uint64_t start = g2l_now();
+    for (int round = 0; round < NUMBER_OF_ROUNDS; round++)
+    {
+        for (int i = 0; i < NUMBER_OF_ITEMS; i++)
+        {
+            tmp.value_1 = i;
+            tmp.value_2 = round;
+            g2l_push(queue, &tmp);
+        }
+        while (g2l_size(queue) > 0)
+        {
+            g2l_shift(queue, &tmp);
+            checksum += tmp.value_1;
+        }
+    }
+    uint64_t end = g2l_now();
+
+    double pairs = (double)NUMBER_OF_ITEMS * NUMBER_OF_ROUNDS;
+    fprintf(stdout, "push + shift: %.2f ns per element (checksum: %lld)\n", (double)(end - start) / pairs, checksum);
+
+    g2l_destroy(queue);
+
+    return 0;
+}
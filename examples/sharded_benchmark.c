@@ -0,0 +1,158 @@
+/*
+    Copyright (c) 2024 BB-301 <fw3dg3@gmail.com> [Official repository](https://github.com/BB-301/c-generic-doubly-linked-list)
+
+    Permission is hereby granted, free of charge, to any person
+    obtaining a copy of this software and associated documentation
+    files (the “Software”), to deal in the Software without restriction,
+    including without limitation the rights to use, copy, modify, merge,
+    publish, distribute, sublicense, and/or sell copies of the Software,
+    and to permit persons to whom the Software is furnished to do so,
+    subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+    THE SOFTWARE.
+*/
+
+/*
+    ==========================
+    Example: Sharded benchmark
+    ==========================
+
+    This example measures the aggregate enqueue/dequeue throughput of
+    a `g2l_sharded_t` queue fed by N producer threads and drained by
+    N consumer threads. The same workload is run with a single lane
+    (which is equivalent to a single `g2l_t` behind a single lock) and
+    then with an increasing number of lanes, up to one lane per thread.
+
+    The number of threads (on each side) can be passed as the first
+    command line argument (e.g., `./sharded_benchmark 8`).
+*/
+
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "g2l.h"
+
+#define ITEMS_PER_PRODUCER (200000)
+#define BATCH_SIZE (32)
+#define DEFAULT_NUMBER_OF_THREADS (4)
+#define DIVIDER "---------------------------------"
+
+struct my_benchmark
+{
+    g2l_sharded_t *queue;
+    size_t total;
+    size_t consumed; // Updated atomically by the consumers
+};
+
+static void *producer(void *arg);
+static void *consumer(void *arg);
+static double run(size_t threads, size_t lanes);
+
+int main(int argc, char **argv)
+{
+    size_t threads = DEFAULT_NUMBER_OF_THREADS;
+    if (argc > 1 && atoi(argv[1]) > 0)
+    {
+        threads = (size_t)atoi(argv[1]);
+    }
+
+    fprintf(stdout, "\n%s\nBENCHMARK: %zu producers / %zu consumers\n%s\n\n", DIVIDER, threads, threads, DIVIDER);
+
+    double baseline = 0.0;
+    // NOTE: lanes = 1, 2, 4, ..., threads
+    for (size_t lanes = 1;; lanes = lanes * 2 < threads ? lanes * 2 : threads)
+    {
+        double ops_per_second = run(threads, lanes);
+        if (lanes == 1)
+        {
+            baseline = ops_per_second;
+        }
+        fprintf(stdout, "lanes = %2zu: %8.2f M ops/s (x%.2f)\n", lanes, ops_per_second / 1e6, ops_per_second / baseline);
+        if (lanes == threads)
+        {
+            break;
+        }
+    }
+    fprintf(stdout, "\n");
+
+    return 0;
+}
+
+static void *producer(void *arg)
+{
+    struct my_benchmark *benchmark = arg;
+    for (uint64_t i = 0; i < ITEMS_PER_PRODUCER; i++)
+    {
+        g2l_sharded_enqueue(benchmark->queue, &i);
+    }
+    return NULL;
+}
+
+static void *consumer(void *arg)
+{
+    struct my_benchmark *benchmark = arg;
+    uint64_t batch[BATCH_SIZE];
+    while (__atomic_load_n(&benchmark->consumed, __ATOMIC_RELAXED) < benchmark->total)
+    {
+        size_t n = g2l_sharded_dequeue_batch(benchmark->queue, batch, BATCH_SIZE);
+        if (n == 0)
+        {
+            sched_yield();
+            continue;
+        }
+        __atomic_fetch_add(&benchmark->consumed, n, __ATOMIC_RELAXED);
+    }
+    return NULL;
+}
+
+static double run(size_t threads, size_t lanes)
+{
+    struct my_benchmark benchmark = {
+        .queue = g2l_sharded_create(sizeof(uint64_t), lanes, true),
+        .total = threads * ITEMS_PER_PRODUCER,
+        .consumed = 0,
+    };
+    pthread_t *ids = malloc(2 * threads * sizeof(pthread_t));
+    if (ids == NULL)
+    {
+        perror("malloc()");
+        abort();
+    }
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (size_t i = 0; i < threads; i++)
+    {
+        pthread_create(&ids[2 * i], NULL, producer, &benchmark);
+        pthread_create(&ids[2 * i + 1], NULL, consumer, &benchmark);
+    }
+    for (size_t i = 0; i < 2 * threads; i++)
+    {
+        pthread_join(ids[i], NULL);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    free(ids);
+    g2l_sharded_destroy(benchmark.queue);
+
+    double seconds = (double)(end.tv_sec - start.tv_sec) + (double)(end.tv_nsec - start.tv_nsec) / 1e9;
+    // NOTE: Each element is enqueued once and dequeued once.
+    return 2.0 * (double)benchmark.total / seconds;
+}
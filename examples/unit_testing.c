@@ -31,12 +31,22 @@
 */
 
 #include <assert.h>
+#include <pthread.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 
 #include "g2l.h"
 
 #define LOG_RUNNING_FUNCTION() fprintf(stdout, "Running '%s'\n", __func__)
+#define LOG_RUNNING_FUNCTION_WITH(variant) fprintf(stdout, "Running '%s' (%s)\n", __func__, variant)
+
+struct my_keyed_data_type
+{
+    uint64_t key;
+    uint32_t sub_key;
+    int value;
+};
 
 enum PROGRAMMING_ERROR_TEST_TO_RUN
 {
@@ -45,18 +55,27 @@ enum PROGRAMMING_ERROR_TEST_TO_RUN
     PROGRAMMING_ERROR_TEST_TO_RUN_NULL_SHIFT,
     PROGRAMMING_ERROR_TEST_TO_RUN_NULL_PUSH,
     PROGRAMMING_ERROR_TEST_TO_RUN_NON_NULL_PUSH,
+    PROGRAMMING_ERROR_TEST_TO_RUN_TTL_INSERT_AT,
 };
 
 static void test_custom_data_type_with_pop_and_shift(void);
 static void test_push_shift_order(void);
 static void test_push_pop_order(void);
 static void test_null_data_type_and_basic_stuff(void);
+static void test_sharded_key_order_and_batch_dequeue(void);
+static void test_sharded_multithreaded(void);
+static void test_ttl_expire_and_next_expiry(void);
+static void test_positional_access(bool indexed);
+static void test_sorted_insert_find_and_range(void);
+static void test_key_find_count_and_remove(bool indexed);
+static void test_concurrent_readers(void);
 
 static void test_programming_error_none(void);
 static void test_programming_error_null_pop(void);
 static void test_programming_error_null_push(void);
 static void test_programming_error_null_shift(void);
 static void test_programming_error_non_null_push(void);
+static void test_programming_error_ttl_insert_at(void);
 
 int main(void)
 {
@@ -64,6 +83,15 @@ int main(void)
     test_push_shift_order();
     test_push_pop_order();
     test_null_data_type_and_basic_stuff();
+    test_sharded_key_order_and_batch_dequeue();
+    test_sharded_multithreaded();
+    test_ttl_expire_and_next_expiry();
+    test_positional_access(false);
+    test_positional_access(true);
+    test_sorted_insert_find_and_range();
+    test_key_find_count_and_remove(false);
+    test_key_find_count_and_remove(true);
+    test_concurrent_readers();
 
     enum PROGRAMMING_ERROR_TEST_TO_RUN to_run = PROGRAMMING_ERROR_TEST_TO_RUN_NONE;
     switch (to_run)
@@ -80,6 +108,9 @@ int main(void)
     case PROGRAMMING_ERROR_TEST_TO_RUN_NON_NULL_PUSH:
         test_programming_error_non_null_push();
         break;
+    case PROGRAMMING_ERROR_TEST_TO_RUN_TTL_INSERT_AT:
+        test_programming_error_ttl_insert_at();
+        break;
     default:
         test_programming_error_none();
     }
@@ -198,6 +229,554 @@ static void test_null_data_type_and_basic_stuff(void)
     g2l_destroy(list);
 }
 
+static void test_sharded_key_order_and_batch_dequeue(void)
+{
+    LOG_RUNNING_FUNCTION();
+    const int n_keys = 3;
+    const int n_per_key = 20;
+    g2l_sharded_t *queue = g2l_sharded_create(sizeof(int), 4, true);
+    assert(g2l_sharded_lanes(queue) == 4);
+    for (int i = 0; i < n_per_key; i++)
+    {
+        for (int key = 0; key < n_keys; key++)
+        {
+            int tmp = key * 1000 + i;
+            assert(g2l_sharded_enqueue_key(queue, (uint64_t)key, &tmp) == 0);
+        }
+    }
+    int tmp = -1;
+    assert(g2l_sharded_enqueue(queue, &tmp) == 0);
+    assert(g2l_sharded_size(queue) == (size_t)(n_keys * n_per_key + 1));
+
+    int next[3] = {0, 0, 0};
+    int batch[7];
+    size_t total = 0;
+    size_t count;
+    bool found_unkeyed = false;
+    while ((count = g2l_sharded_dequeue_batch(queue, batch, 7)) > 0)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            if (batch[i] == -1)
+            {
+                found_unkeyed = true;
+                continue;
+            }
+            int key = batch[i] / 1000;
+            assert(batch[i] % 1000 == next[key]);
+            next[key] += 1;
+        }
+        total += count;
+    }
+    assert(found_unkeyed);
+    assert(total == (size_t)(n_keys * n_per_key + 1));
+    assert(g2l_sharded_size(queue) == 0);
+    assert(!g2l_sharded_dequeue(queue, &tmp));
+
+    tmp = 42;
+    g2l_sharded_enqueue(queue, &tmp);
+    tmp = 0;
+    assert(g2l_sharded_dequeue(queue, &tmp));
+    assert(tmp == 42);
+
+    g2l_sharded_enqueue(queue, &tmp);
+    g2l_sharded_destroy(queue);
+}
+
+#define SHARDED_TEST_THREADS (4)
+#define SHARDED_TEST_ITEMS_PER_PRODUCER (20000)
+
+struct my_sharded_test
+{
+    g2l_sharded_t *queue;
+    size_t consumed;     // Accessed atomically
+    unsigned char *seen; // Accessed atomically
+};
+
+struct my_sharded_test_thread
+{
+    struct my_sharded_test *test;
+    int id;
+};
+
+static void *test_sharded_producer(void *arg)
+{
+    struct my_sharded_test_thread *thread = arg;
+    for (int i = 0; i < SHARDED_TEST_ITEMS_PER_PRODUCER; i++)
+    {
+        int tmp = thread->id * SHARDED_TEST_ITEMS_PER_PRODUCER + i;
+        // NOTE: Half of the producers rely on their home lane instead of a key.
+        if (thread->id % 2 == 0)
+        {
+            assert(g2l_sharded_enqueue_key(thread->test->queue, (uint64_t)thread->id, &tmp) == 0);
+        }
+        else
+        {
+            assert(g2l_sharded_enqueue(thread->test->queue, &tmp) == 0);
+        }
+    }
+    return NULL;
+}
+
+static void *test_sharded_consumer(void *arg)
+{
+    struct my_sharded_test_thread *thread = arg;
+    struct my_sharded_test *test = thread->test;
+    const size_t total = SHARDED_TEST_THREADS * SHARDED_TEST_ITEMS_PER_PRODUCER;
+    int last[SHARDED_TEST_THREADS];
+    for (int i = 0; i < SHARDED_TEST_THREADS; i++)
+    {
+        last[i] = -1;
+    }
+    int batch[16];
+    while (__atomic_load_n(&test->consumed, __ATOMIC_RELAXED) < total)
+    {
+        size_t count = g2l_sharded_dequeue_batch(test->queue, batch, 1 + (size_t)thread->id * 5);
+        for (size_t i = 0; i < count; i++)
+        {
+            int producer = batch[i] / SHARDED_TEST_ITEMS_PER_PRODUCER;
+            int sequence = batch[i] % SHARDED_TEST_ITEMS_PER_PRODUCER;
+            // Each producer's elements are seen in order by any given consumer...
+            assert(sequence > last[producer]);
+            last[producer] = sequence;
+            // ... and each element is dequeued exactly once.
+            assert(__atomic_exchange_n(&test->seen[batch[i]], 1, __ATOMIC_RELAXED) == 0);
+        }
+        __atomic_fetch_add(&test->consumed, count, __ATOMIC_RELAXED);
+    }
+    return NULL;
+}
+
+static void test_sharded_multithreaded(void)
+{
+    LOG_RUNNING_FUNCTION();
+    const size_t total = SHARDED_TEST_THREADS * SHARDED_TEST_ITEMS_PER_PRODUCER;
+    struct my_sharded_test test = {
+        .queue = g2l_sharded_create(sizeof(int), SHARDED_TEST_THREADS, true),
+        .consumed = 0,
+        .seen = calloc(total, 1),
+    };
+    assert(test.seen != NULL);
+
+    pthread_t producers[SHARDED_TEST_THREADS];
+    pthread_t consumers[SHARDED_TEST_THREADS];
+    struct my_sharded_test_thread threads[SHARDED_TEST_THREADS];
+    for (int i = 0; i < SHARDED_TEST_THREADS; i++)
+    {
+        threads[i] = (struct my_sharded_test_thread){.test = &test, .id = i};
+        pthread_create(&producers[i], NULL, test_sharded_producer, &threads[i]);
+        pthread_create(&consumers[i], NULL, test_sharded_consumer, &threads[i]);
+    }
+    for (int i = 0; i < SHARDED_TEST_THREADS; i++)
+    {
+        pthread_join(producers[i], NULL);
+        pthread_join(consumers[i], NULL);
+    }
+
+    assert(test.consumed == total);
+    for (size_t i = 0; i < total; i++)
+    {
+        assert(test.seen[i] == 1);
+    }
+    assert(g2l_sharded_size(test.queue) == 0);
+    assert(!g2l_sharded_dequeue(test.queue, NULL));
+
+    free(test.seen);
+    g2l_sharded_destroy(test.queue);
+}
+
+static void test_ttl_expire_callback(void const *data, uint64_t timestamp, void *context)
+{
+    int *expected = context;
+    assert(*(int const *)data == *expected);
+    assert(timestamp <= g2l_now());
+    *expected += 1;
+}
+
+static void test_ttl_expire_and_next_expiry(void)
+{
+    LOG_RUNNING_FUNCTION();
+    const uint64_t ttl = 1000000000;
+    g2l_t *list = g2l_create_ttl(sizeof(int), ttl, true);
+    uint64_t expiry;
+    assert(!g2l_next_expiry(list, &expiry));
+
+    uint64_t before = g2l_now();
+    for (int i = 0; i < 10; i++)
+    {
+        g2l_push(list, &i);
+    }
+    assert(g2l_next_expiry(list, &expiry));
+    assert(expiry >= before + ttl);
+
+    // Nothing has expired yet
+    assert(g2l_expire(list, before, SIZE_MAX, NULL, NULL) == 0);
+    assert(g2l_size(list) == 10);
+
+    // The oldest element expires first
+    int expected = 0;
+    assert(g2l_expire(list, expiry, SIZE_MAX, test_ttl_expire_callback, &expected) >= 1);
+    assert((size_t)expected + g2l_size(list) == 10);
+
+    // At most `max` elements are evicted
+    int first = expected;
+    size_t remaining = g2l_size(list);
+    assert(g2l_expire(list, UINT64_MAX, 2, test_ttl_expire_callback, &expected) == (remaining < 2 ? remaining : 2));
+    assert(expected - first == (int)(remaining < 2 ? remaining : 2));
+
+    // The live elements are left untouched
+    int tmp;
+    if (g2l_shift(list, &tmp))
+    {
+        assert(tmp == expected);
+        expected += 1;
+    }
+    remaining = g2l_size(list);
+    assert(g2l_expire(list, UINT64_MAX, SIZE_MAX, test_ttl_expire_callback, &expected) == remaining);
+    assert(expected == 10);
+    assert(g2l_size(list) == 0);
+    assert(!g2l_next_expiry(list, &expiry));
+
+    g2l_push(list, &tmp);
+    // Inserting at the youngest end is the same as pushing
+    assert(g2l_insert_at(list, g2l_size(list), &tmp) == 0);
+    assert(g2l_pop(list, &tmp));
+    assert(g2l_pop(list, &tmp));
+    assert(g2l_size(list) == 0);
+
+    g2l_destroy(list);
+
+    // Very large TTLs must not overflow
+    list = g2l_create_ttl(sizeof(int), UINT64_MAX, true);
+    g2l_push(list, &tmp);
+    assert(g2l_expire(list, g2l_now(), SIZE_MAX, NULL, NULL) == 0);
+    assert(g2l_expire(list, UINT64_MAX - 1, SIZE_MAX, NULL, NULL) == 0);
+    assert(g2l_next_expiry(list, &expiry));
+    assert(expiry == UINT64_MAX);
+    assert(g2l_size(list) == 1);
+
+    g2l_destroy(list);
+}
+
+static void test_positional_access(bool indexed)
+{
+    LOG_RUNNING_FUNCTION_WITH(indexed ? "g2l_create_indexed" : "g2l_create");
+    g2l_t *list = indexed ? g2l_create_indexed(sizeof(int), true) : g2l_create(sizeof(int), true);
+    // NOTE: A plain array is used as the reference model.
+    enum
+    {
+        capacity = 2000
+    };
+    static int model[capacity];
+    size_t n = 0;
+    int tmp;
+    unsigned int seed = 12345;
+
+    assert(!g2l_at(list, 0, &tmp));
+    assert(!g2l_remove_at(list, 0, &tmp));
+
+    for (int i = 0; i < 20000; i++)
+    {
+        seed = seed * 1103515245u + 12345u;
+        unsigned int r = (seed >> 8) % 100;
+        if (r < 35 && n < capacity)
+        {
+            size_t index = (seed >> 4) % (n + 1);
+            assert(g2l_insert_at(list, index, &i) == 0);
+            for (size_t j = n; j > index; j--)
+            {
+                model[j] = model[j - 1];
+            }
+            model[index] = i;
+            n += 1;
+        }
+        else if (r < 45 && n < capacity)
+        {
+            g2l_push(list, &i);
+            model[n++] = i;
+        }
+        else if (r < 60 && n > 0)
+        {
+            size_t index = (seed >> 4) % n;
+            assert(g2l_remove_at(list, index, &tmp));
+            assert(tmp == model[index]);
+            for (size_t j = index; j + 1 < n; j++)
+            {
+                model[j] = model[j + 1];
+            }
+            n -= 1;
+        }
+        else if (r < 65 && n > 0)
+        {
+            assert(g2l_shift(list, &tmp));
+            assert(tmp == model[0]);
+            for (size_t j = 0; j + 1 < n; j++)
+            {
+                model[j] = model[j + 1];
+            }
+            n -= 1;
+        }
+        else if (r < 70 && n > 0)
+        {
+            assert(g2l_pop(list, &tmp));
+            assert(tmp == model[--n]);
+        }
+        else if (n > 0)
+        {
+            size_t index = (seed >> 4) % n;
+            assert(g2l_at(list, index, &tmp));
+            assert(tmp == model[index]);
+            // Nearby accesses (i.e., served by the finger)
+            if (index + 1 < n)
+            {
+                assert(g2l_at(list, index + 1, &tmp));
+                assert(tmp == model[index + 1]);
+            }
+        }
+        assert(g2l_size(list) == n);
+    }
+
+    for (size_t i = 0; i < n; i++)
+    {
+        assert(g2l_at(list, i, &tmp));
+        assert(tmp == model[i]);
+    }
+    assert(!g2l_at(list, n, NULL));
+
+    g2l_clear(list);
+    assert(!g2l_at(list, 0, NULL));
+    tmp = 7;
+    assert(g2l_insert_at(list, 0, &tmp) == 0);
+    assert(g2l_at(list, 0, &tmp) && tmp == 7);
+
+    g2l_destroy(list);
+}
+
+struct my_sorted_data_type
+{
+    int key;
+    int sequence;
+};
+
+static int test_sorted_compare(void const *a, void const *b)
+{
+    int x = ((struct my_sorted_data_type const *)a)->key;
+    int y = ((struct my_sorted_data_type const *)b)->key;
+    return (x > y) - (x < y);
+}
+
+static void test_sorted_insert_find_and_range(void)
+{
+    LOG_RUNNING_FUNCTION();
+    enum
+    {
+        n = 5000,
+        max_key = 1000
+    };
+    static int counts[max_key];
+    g2l_t *list = g2l_create_sorted(sizeof(struct my_sorted_data_type), test_sorted_compare, true);
+    struct my_sorted_data_type tmp;
+    unsigned int seed = 42;
+    for (int i = 0; i < n; i++)
+    {
+        seed = seed * 1103515245u + 12345u;
+        tmp.key = (int)((seed >> 8) % max_key);
+        tmp.sequence = i;
+        assert(g2l_insert_sorted(list, &tmp) == 0);
+        counts[tmp.key] += 1;
+    }
+    assert(g2l_size(list) == n);
+
+    // Ordered (and stable) traversal
+    struct my_sorted_data_type previous = {-1, -1};
+    for (size_t i = 0; g2l_at(list, i, &tmp); i++)
+    {
+        assert(tmp.key > previous.key || (tmp.key == previous.key && tmp.sequence > previous.sequence));
+        previous = tmp;
+    }
+
+    // Lookups and ranges
+    size_t expected_index = 0;
+    for (int key = 0; key < max_key; key++)
+    {
+        struct my_sorted_data_type query = {key, 0};
+        assert(g2l_lower_bound(list, &query) == expected_index);
+        size_t end = g2l_upper_bound(list, &query);
+        assert(end == expected_index + (size_t)counts[key]);
+        assert(g2l_find(list, &query, &tmp) == (counts[key] > 0));
+        for (size_t i = g2l_lower_bound(list, &query); i < end; i++)
+        {
+            assert(g2l_at(list, i, &tmp));
+            assert(tmp.key == key);
+        }
+        expected_index = end;
+    }
+    struct my_sorted_data_type query = {max_key, 0};
+    assert(g2l_lower_bound(list, &query) == n);
+    assert(!g2l_find(list, &query, NULL));
+
+    // Min and max ends
+    assert(g2l_shift(list, &tmp));
+    int min = tmp.key;
+    assert(g2l_pop(list, &tmp));
+    int max = tmp.key;
+    assert(min <= max);
+    // Popping the maximum must keep the index consistent
+    for (int i = 0; i < n / 2; i++)
+    {
+        assert(g2l_pop(list, &tmp));
+        assert(tmp.key <= max);
+        max = tmp.key;
+        struct my_sorted_data_type last;
+        assert(g2l_at(list, g2l_size(list) - 1, &last));
+        assert(last.key <= max);
+        query.key = max;
+        assert(g2l_upper_bound(list, &query) == g2l_size(list));
+        if (i % 100 == 0)
+        {
+            assert(g2l_insert_sorted(list, &tmp) == 0);
+            assert(g2l_pop(list, &last));
+            assert(last.key == tmp.key && last.sequence == tmp.sequence);
+        }
+    }
+    while (g2l_shift(list, &tmp))
+    {
+        assert(tmp.key >= min && tmp.key <= max);
+        min = tmp.key;
+    }
+
+    g2l_destroy(list);
+}
+
+static void test_key_find_count_and_remove(bool indexed)
+{
+    LOG_RUNNING_FUNCTION_WITH(indexed ? "g2l_create_indexed" : "g2l_create");
+    g2l_t *list = indexed ? g2l_create_indexed(sizeof(struct my_keyed_data_type), true) : g2l_create(sizeof(struct my_keyed_data_type), true);
+    const int n = 1000;
+    struct my_keyed_data_type tmp;
+    for (int i = 0; i < n; i++)
+    {
+        tmp.key = (uint64_t)(i % 7);
+        tmp.sub_key = (uint32_t)(i % 7);
+        tmp.value = i;
+        g2l_push(list, &tmp);
+    }
+
+    uint64_t key = 3;
+    size_t index;
+    assert(g2l_find_first(list, &key, sizeof(key), &index, &tmp));
+    assert(index == 3 && tmp.value == 3);
+    assert(g2l_count_if_key(list, &key, sizeof(key)) == (size_t)((n - 3 + 6) / 7));
+    key = 7;
+    assert(!g2l_find_first(list, &key, sizeof(key), NULL, NULL));
+    assert(g2l_count_if_key(list, &key, sizeof(key)) == 0);
+
+    // Keys that are neither 4 nor 8 bytes long
+    struct my_keyed_data_type prefix = {5, 5, 0};
+    assert(g2l_count_if_key(list, &prefix, sizeof(uint64_t) + sizeof(uint32_t)) == (size_t)((n - 5 + 6) / 7));
+
+    key = 3;
+    size_t removed = g2l_remove_if_key(list, &key, sizeof(key));
+    assert(removed == (size_t)((n - 3 + 6) / 7));
+    assert(g2l_size(list) == n - removed);
+    assert(g2l_count_if_key(list, &key, sizeof(key)) == 0);
+    size_t expected = 0;
+    for (size_t i = 0; g2l_at(list, i, &tmp); i++)
+    {
+        if (expected % 7 == 3)
+        {
+            expected += 1;
+        }
+        assert(tmp.value == (int)expected);
+        expected += 1;
+    }
+
+    key = 0;
+    assert(g2l_find_first(list, &key, sizeof(key), &index, &tmp));
+    assert(index == 0 && tmp.value == 0);
+
+    g2l_destroy(list);
+}
+
+struct my_concurrent_test
+{
+    g2l_t *list;
+    bool done; // Accessed atomically
+};
+
+static void *test_concurrent_reader(void *arg)
+{
+    struct my_concurrent_test *test = arg;
+    while (!__atomic_load_n(&test->done, __ATOMIC_ACQUIRE))
+    {
+        g2l_reader_t *reader = g2l_read_begin(test->list);
+        assert(reader != NULL);
+        int previous = -1;
+        int tmp;
+        while (g2l_read_next(reader, &tmp))
+        {
+            assert(tmp > previous);
+            previous = tmp;
+        }
+        g2l_read_end(reader);
+    }
+    return NULL;
+}
+
+static void test_concurrent_readers(void)
+{
+    LOG_RUNNING_FUNCTION();
+    struct my_concurrent_test test = {
+        .list = g2l_create_concurrent(sizeof(int), true),
+        .done = false,
+    };
+    int tmp;
+
+    // Single-threaded semantics
+    for (int i = 0; i < 10; i++)
+    {
+        g2l_push(test.list, &i);
+    }
+    g2l_reader_t *reader = g2l_read_begin(test.list);
+    assert(g2l_shift(test.list, &tmp) && tmp == 0);
+    assert(g2l_read_next(reader, &tmp) && tmp == 1);
+    assert(g2l_pop(test.list, &tmp) && tmp == 9);
+    // The removed elements stay valid until the reader is done
+    assert(g2l_shift(test.list, &tmp) && tmp == 1);
+    assert(g2l_reclaim(test.list) == 0);
+    for (int i = 2; i < 9; i++)
+    {
+        assert(g2l_read_next(reader, &tmp) && tmp == i);
+    }
+    assert(!g2l_read_next(reader, &tmp));
+    assert(!g2l_read_next(reader, &tmp));
+    g2l_read_end(reader);
+    assert(g2l_reclaim(test.list) == 3);
+
+    // One writer and two readers
+    g2l_clear(test.list);
+    pthread_t readers[2];
+    for (int i = 0; i < 2; i++)
+    {
+        pthread_create(&readers[i], NULL, test_concurrent_reader, &test);
+    }
+    for (int i = 0; i < 200000; i++)
+    {
+        g2l_push(test.list, &i);
+        if (g2l_size(test.list) > 100)
+        {
+            g2l_shift(test.list, NULL);
+        }
+    }
+    __atomic_store_n(&test.done, true, __ATOMIC_RELEASE);
+    for (int i = 0; i < 2; i++)
+    {
+        pthread_join(readers[i], NULL);
+    }
+
+    g2l_destroy(test.list);
+}
+
 static void test_programming_error_none(void)
 {
     LOG_RUNNING_FUNCTION();
@@ -237,3 +816,13 @@ static void test_programming_error_non_null_push(void)
     g2l_push(list, &tmp);
     g2l_destroy(list);
 }
+
+static void test_programming_error_ttl_insert_at(void)
+{
+    LOG_RUNNING_FUNCTION();
+    g2l_t *list = g2l_create_ttl(sizeof(int), 1000, true);
+    int tmp = 0;
+    g2l_push(list, &tmp);
+    g2l_insert_at(list, 0, &tmp);
+    g2l_destroy(list);
+}
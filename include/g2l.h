@@ -29,8 +29,35 @@
 #define _G2L_H_
 
 #include <stdbool.h>
+#include <stdint.h>
 #include <sys/types.h>
 
+/**
+ * @brief A macro prepended to the declaration of every function of the library's
+ * public API.
+ * @note - By default, this macro is empty, and the functions are provided by the
+ * compiled library (i.e., `libg2l.a` or `libg2l.so`).
+ * @note - If `G2L_HEADER_ONLY` is defined before including this header, the implementation
+ * (i.e., `src/g2l.c`, which must then be reachable through the include path) is included
+ * at the end of this header, and this macro expands to `static inline`, so that the compiler
+ * can inline the hot paths (e.g., \ref g2l_push , \ref g2l_shift , \ref g2l_size ) into the
+ * application's code without relying on link-time optimization.
+ * @note - In header-only mode, the implementation relies on POSIX functions (e.g., `clock_gettime`),
+ * so when compiling with a strict ISO C mode (e.g., `gcc -std=c17`), `_POSIX_C_SOURCE` must be defined
+ * (e.g., `-D_POSIX_C_SOURCE=200809L`) before the first system header is included.
+ * @note - In header-only mode, the library's internal types and functions become visible to
+ * the application, but they all use the `g2l_` prefix (and the internal macros are undefined
+ * at the end of the implementation), so the application only needs to avoid that prefix.
+ * @note - The application can also define this macro itself (e.g., to add attributes).
+ */
+#ifndef G2L_INLINE
+#ifdef G2L_HEADER_ONLY
+#define G2L_INLINE static inline
+#else
+#define G2L_INLINE
+#endif
+#endif
+
 /**
  * @brief An opaque data type used as a container for the
  * **generic doubly linked list** implementation, and which
@@ -61,14 +88,115 @@ typedef struct g2l_t g2l_t;
  * of \ref malloc , and which could consequently obtain \ref ENOMEM .
  * @see g2l_destroy
  */
-g2l_t *g2l_create(size_t data_size, bool abort_on_enomem);
+G2L_INLINE g2l_t *g2l_create(size_t data_size, bool abort_on_enomem);
+
+/**
+ * @brief The function that can be used to instantiate a new linked list
+ * object (i.e., \ref g2l_t ) in "TTL" (i.e., time to live) mode, in which each
+ * element records the time at which it was inserted, so that stale elements
+ * can later be evicted in batches using \ref g2l_expire .
+ * @param data_size The size, in bytes, of the data type that will be
+ * stored in the created instance.
+ * @param ttl The time to live, in nanoseconds, of the elements. An element
+ * inserted at time `t` (as returned by \ref g2l_now ) is considered expired
+ * once `now - t >= ttl`. Passing \ref UINT64_MAX means that the elements
+ * never expire.
+ * @param abort_on_enomem Whether \ref ENOMEM errors should result in
+ * the process being aborted (`true`) or whether the function should
+ * simply return the \ref NULL pointer and let the application deal
+ * with the error.
+ * @return \ref g2l_t* A pointer to the created linked list object.
+ * @note - Apart from recording the insertion time, a list created with this
+ * function behaves exactly like one created with \ref g2l_create , except that
+ * new elements can only be added at the youngest end (i.e., using \ref g2l_push ),
+ * since \ref g2l_expire relies on the elements being ordered by insertion time.
+ * @see g2l_expire, g2l_next_expiry, g2l_now
+ */
+G2L_INLINE g2l_t *g2l_create_ttl(size_t data_size, uint64_t ttl, bool abort_on_enomem);
+
+/**
+ * @brief The function that can be used to instantiate a new linked list
+ * object (i.e., \ref g2l_t ) whose elements are additionally indexed by
+ * a skip list, so that \ref g2l_at , \ref g2l_insert_at and \ref g2l_remove_at
+ * run in `O(log n)` for arbitrary indices.
+ * @param data_size The size, in bytes, of the data type that will be
+ * stored in the created instance.
+ * @param abort_on_enomem Whether \ref ENOMEM errors should result in
+ * the process being aborted (`true`) or whether the function should
+ * simply return the \ref NULL pointer and let the application deal
+ * with the error.
+ * @return \ref g2l_t* A pointer to the created linked list object.
+ * @note - The index has a cost: \ref g2l_push becomes `O(log n)` instead of `O(1)`
+ * (\ref g2l_shift and \ref g2l_pop remain cheap), and roughly one node out of
+ * four carries a small additional allocation. Lists on which positional access
+ * is rare, or always close to a previously accessed position, should rather be
+ * created with \ref g2l_create .
+ * @see g2l_at, g2l_insert_at, g2l_remove_at
+ */
+G2L_INLINE g2l_t *g2l_create_indexed(size_t data_size, bool abort_on_enomem);
+
+/**
+ * @brief The type of the function used by lists created with \ref g2l_create_sorted
+ * to order their elements.
+ * @param a A pointer to the first element's data.
+ * @param b A pointer to the second element's data.
+ * @return \ref int A negative value if \p a should come before \p b , a positive value
+ * if \p a should come after \p b , and `0` if they are equivalent (i.e., the same
+ * contract as the comparison function used by \ref qsort ).
+ */
+typedef int (*g2l_compare_t)(void const *a, void const *b);
+
+/**
+ * @brief The function that can be used to instantiate a new linked list object
+ * (i.e., \ref g2l_t ) that keeps its elements sorted according to \p compare .
+ * @param data_size The size, in bytes, of the data type that will be
+ * stored in the created instance. A value of `0` is a programming error.
+ * @param compare The function used to order the elements (see \ref g2l_compare_t ).
+ * @param abort_on_enomem Whether \ref ENOMEM errors should result in
+ * the process being aborted (`true`) or whether the function should
+ * simply return the \ref NULL pointer and let the application deal
+ * with the error.
+ * @return \ref g2l_t* A pointer to the created linked list object.
+ * @note - Elements are ordered from smallest (position `0`, see \ref g2l_at ) to greatest,
+ * so \ref g2l_shift removes the minimum and \ref g2l_pop removes the maximum, both without
+ * searching the skip list.
+ * @note - The list is indexed by a skip list (see \ref g2l_create_indexed ), which makes
+ * \ref g2l_insert_sorted , \ref g2l_find , \ref g2l_lower_bound and \ref g2l_upper_bound
+ * run in `O(log n)`.
+ * @note - Since they specify a position, calling \ref g2l_push (or \ref g2l_enqueue ) and
+ * \ref g2l_insert_at on a sorted list is a programming error.
+ * @see g2l_insert_sorted, g2l_find, g2l_lower_bound, g2l_upper_bound
+ */
+G2L_INLINE g2l_t *g2l_create_sorted(size_t data_size, g2l_compare_t compare, bool abort_on_enomem);
+
+/**
+ * @brief The function that can be used to instantiate a new linked list object
+ * (i.e., \ref g2l_t ) that can be traversed by reader threads (see \ref g2l_read_begin )
+ * while a single writer thread keeps modifying it, without any lock.
+ * @param data_size The size, in bytes, of the data type that will be
+ * stored in the created instance.
+ * @param abort_on_enomem Whether \ref ENOMEM errors should result in
+ * the process being aborted (`true`) or whether the function should
+ * simply return the \ref NULL pointer and let the application deal
+ * with the error.
+ * @return \ref g2l_t* A pointer to the created linked list object.
+ * @note - All of the functions that modify the list (e.g., \ref g2l_push , \ref g2l_shift ,
+ * \ref g2l_remove_at ) must still be called from a single thread at a time (i.e., "the writer").
+ * Only \ref g2l_read_begin , \ref g2l_read_next and \ref g2l_read_end may be called
+ * concurrently with the writer.
+ * @note - The elements removed by the writer are not freed right away: they are freed in
+ * batches, once all of the readers that may still be traversing them have called
+ * \ref g2l_read_end (see \ref g2l_reclaim ). The writer never waits for the readers.
+ * @see g2l_read_begin, g2l_read_next, g2l_read_end, g2l_reclaim
+ */
+G2L_INLINE g2l_t *g2l_create_concurrent(size_t data_size, bool abort_on_enomem);
 
 /**
  * @brief A function that can be used to clear (i.e., empty) a linked list
  * object.
  * @param self A pointer to the \ref g2l_t instance to be cleared.
  */
-void g2l_clear(g2l_t *self);
+G2L_INLINE void g2l_clear(g2l_t *self);
 
 /**
  * @brief The function that should be used to destroy a linked list object
@@ -76,7 +204,7 @@ void g2l_clear(g2l_t *self);
  * @param self A pointer to the \ref g2l_t instance to be destroyed.
  * @see g2l_create
  */
-void g2l_destroy(g2l_t *self);
+G2L_INLINE void g2l_destroy(g2l_t *self);
 
 /**
  * @brief A function that can be used to retrieve the current number
@@ -85,7 +213,7 @@ void g2l_destroy(g2l_t *self);
  * the number of internal elements.
  * @return \ref size_t The number of elements in the \p self linked list object.
  */
-size_t g2l_size(g2l_t const *self);
+G2L_INLINE size_t g2l_size(g2l_t const *self);
 
 /**
  * @brief The function that must be used to add a new element to
@@ -105,7 +233,7 @@ size_t g2l_size(g2l_t const *self);
  * @note - The \ref g2l_enqueue function is an alias for \ref g2l_push .
  * @see g2l_enqueue
  */
-int g2l_push(g2l_t *self, void const *data);
+G2L_INLINE int g2l_push(g2l_t *self, void const *data);
 
 /**
  * @brief The function that must be used to "pop" the stack (and optionally retrieve
@@ -119,7 +247,7 @@ int g2l_push(g2l_t *self, void const *data);
  * whether a value was popped). A `false` value simply means that the list was already
  * empty at the moment when the operation was performed, else the value will be `true`.
  */
-bool g2l_pop(g2l_t *self, void *data);
+G2L_INLINE bool g2l_pop(g2l_t *self, void *data);
 
 /**
  * @brief The function that must be used to "shift" the list's oldest element (and optionally
@@ -135,7 +263,7 @@ bool g2l_pop(g2l_t *self, void *data);
  * @note - The \ref g2l_dequeue function is an alias for \ref g2l_shift .
  * @see g2l_dequeue
  */
-bool g2l_shift(g2l_t *self, void *data);
+G2L_INLINE bool g2l_shift(g2l_t *self, void *data);
 
 /**
  * @brief An alias to \ref g2l_push , a function that can be used to "enqueue"
@@ -152,7 +280,7 @@ bool g2l_shift(g2l_t *self, void *data);
  * @note - The \ref g2l_enqueue function is an alias for \ref g2l_push .
  * @see g2l_push
  */
-bool g2l_enqueue(g2l_t *self, void const *data);
+G2L_INLINE bool g2l_enqueue(g2l_t *self, void const *data);
 
 /**
  * @brief An alias to \ref g2l_shift , this function can be used to
@@ -169,6 +297,416 @@ bool g2l_enqueue(g2l_t *self, void const *data);
  * @note - The \ref g2l_dequeue function is an alias for \ref g2l_shift .
  * @see g2l_shift
  */
-bool g2l_dequeue(g2l_t *self, void *data);
+G2L_INLINE bool g2l_dequeue(g2l_t *self, void *data);
+
+/**
+ * @brief A function that can be used to retrieve (without removing it) the element located
+ * at position \p index in the linked list object \p self .
+ * @param self A pointer to the \ref g2l_t instance from which to retrieve the element.
+ * @param index The position of the element, where `0` corresponds to the list's oldest element
+ * (i.e., the one that would be returned by \ref g2l_shift ) and `g2l_size(self) - 1` to its
+ * youngest element (i.e., the one that would be returned by \ref g2l_pop ).
+ * @param data A pointer to memory into which the element's data should be copied. The \ref NULL
+ * pointer can be passed if the data is not needed by the application.
+ * @return \ref bool A boolean value that will be `false` if \p index is out of range, else `true`.
+ * @note - The list is walked from whichever end is closest, or from the position of the
+ * last positional access (i.e., the cached "finger") if that is closer, which makes
+ * sequential access (e.g., `for (i = 0; g2l_at(list, i, &tmp); i++)`) `O(1)` per element.
+ * For lists created using \ref g2l_create_indexed , arbitrary positions are reached in `O(log n)`.
+ * @note - This function takes a non-const \p self because it updates the cached finger.
+ * @see g2l_insert_at, g2l_remove_at
+ */
+G2L_INLINE bool g2l_at(g2l_t *self, size_t index, void *data);
+
+/**
+ * @brief A function that can be used to insert a new element at position \p index
+ * in the linked list object \p self .
+ * @param self A pointer to the \ref g2l_t instance into which to insert the new element.
+ * @param index The position that the new element will occupy once inserted (see \ref g2l_at ).
+ * The elements previously located at positions greater than or equal to \p index are shifted
+ * by one. Passing `g2l_size(self)` is equivalent to calling \ref g2l_push , while passing a
+ * value greater than that is a programming error.
+ * @param data A pointer to arbitrary memory of size defined when instantiating
+ * the object using \ref g2l_create , which is to be copied and stored inside
+ * the linked list object \p self .
+ * @return \ref int An integer value that will be `0` if the new element was successfully
+ * added, else it will be \ref ENOMEM .
+ * @note - See the documentation for \ref g2l_push for a discussion about the possible
+ * returned values, and the documentation for \ref g2l_at for a discussion about the
+ * cost of reaching \p index .
+ * @note - Calling this function on a list created using \ref g2l_create_sorted , or with an
+ * \p index other than `g2l_size(self)` on a list created using \ref g2l_create_ttl , is a
+ * programming error.
+ * @see g2l_at, g2l_remove_at
+ */
+G2L_INLINE int g2l_insert_at(g2l_t *self, size_t index, void const *data);
+
+/**
+ * @brief A function that can be used to remove the element located at position \p index
+ * in the linked list object \p self (and optionally retrieve its value).
+ * @param self A pointer to the \ref g2l_t instance from which to remove the element.
+ * @param index The position of the element to be removed (see \ref g2l_at ).
+ * @param data A pointer to memory into which the element's data should be copied
+ * before the element is freed. The \ref NULL pointer can be passed if the data is not
+ * needed by the application.
+ * @return \ref bool A boolean value that will be `false` if \p index is out of range, else `true`.
+ * @note - See the documentation for \ref g2l_at for a discussion about the cost of
+ * reaching \p index .
+ * @see g2l_at, g2l_insert_at
+ */
+G2L_INLINE bool g2l_remove_at(g2l_t *self, size_t index, void *data);
+
+/**
+ * @brief The function that must be used to add a new element to a list created
+ * with \ref g2l_create_sorted .
+ * @param self A pointer to the sorted \ref g2l_t instance into which to insert
+ * the new element.
+ * @param data A pointer to arbitrary memory of size defined when instantiating
+ * the object, which is to be copied and stored inside the linked list object \p self .
+ * @return \ref int An integer value that will be `0` if the new element was successfully
+ * added, else it will be \ref ENOMEM .
+ * @note - The new element is inserted after the elements that compare equal to it,
+ * so elements with equal keys keep their insertion order.
+ * @see g2l_create_sorted
+ */
+G2L_INLINE int g2l_insert_sorted(g2l_t *self, void const *data);
+
+/**
+ * @brief A function that can be used to look up an element in a list created
+ * with \ref g2l_create_sorted .
+ * @param self A pointer to the sorted \ref g2l_t instance in which to search.
+ * @param key A pointer to the value to search for, which is passed as is to the
+ * list's comparison function.
+ * @param data A pointer to memory into which the data of the first element comparing
+ * equal to \p key should be copied. The \ref NULL pointer can be passed if the data
+ * is not needed by the application.
+ * @return \ref bool A boolean value indicating whether such an element was found.
+ * @see g2l_lower_bound
+ */
+G2L_INLINE bool g2l_find(g2l_t *self, void const *key, void *data);
+
+/**
+ * @brief A function that returns the position (see \ref g2l_at ) of the first element,
+ * in a list created with \ref g2l_create_sorted , that does not compare less than \p key .
+ * @param self A pointer to the sorted \ref g2l_t instance in which to search.
+ * @param key A pointer to the value to search for, which is passed as is to the
+ * list's comparison function.
+ * @return \ref size_t The position of the element, or `g2l_size(self)` if all of the
+ * elements compare less than \p key .
+ * @note - The returned position becomes the list's cached finger, so that iterating
+ * over a range using \ref g2l_at costs `O(1)` per element, e.g.:
+ * `end = g2l_upper_bound(list, &hi); for (i = g2l_lower_bound(list, &lo); i < end; i++) g2l_at(list, i, &tmp);`
+ * @see g2l_upper_bound
+ */
+G2L_INLINE size_t g2l_lower_bound(g2l_t *self, void const *key);
+
+/**
+ * @brief A function that returns the position (see \ref g2l_at ) of the first element,
+ * in a list created with \ref g2l_create_sorted , that compares greater than \p key .
+ * @param self A pointer to the sorted \ref g2l_t instance in which to search.
+ * @param key A pointer to the value to search for, which is passed as is to the
+ * list's comparison function.
+ * @return \ref size_t The position of the element, or `g2l_size(self)` if none of the
+ * elements compare greater than \p key .
+ * @see g2l_lower_bound
+ */
+G2L_INLINE size_t g2l_upper_bound(g2l_t *self, void const *key);
+
+/**
+ * @brief A function that can be used to find the oldest element whose data starts
+ * with the \p key_size bytes pointed to by \p key .
+ * @param self A pointer to the \ref g2l_t instance in which to search.
+ * @param key A pointer to the key, which is compared byte for byte with the beginning
+ * of each element's data (e.g., a leading `uint32_t` or `uint64_t` identifier).
+ * @param key_size The size, in bytes, of the key, which must be greater than `0` and
+ * at most equal to the list's `data_size`.
+ * @param index A pointer to memory into which the position (see \ref g2l_at ) of the
+ * found element will be written. The \ref NULL pointer can be passed if the position
+ * is not needed by the application.
+ * @param data A pointer to memory into which the found element's data should be copied.
+ * The \ref NULL pointer can be passed if the data is not needed by the application.
+ * @return \ref bool A boolean value indicating whether a matching element was found.
+ * @note - Keys of 4 and 8 bytes are compared using a single integer comparison, and the
+ * elements' data is prefetched in batches while walking the list, so that the memory
+ * accesses of several elements overlap.
+ * @see g2l_count_if_key, g2l_remove_if_key
+ */
+G2L_INLINE bool g2l_find_first(g2l_t *self, void const *key, size_t key_size, size_t *index, void *data);
+
+/**
+ * @brief A function that can be used to count the elements whose data starts with
+ * the \p key_size bytes pointed to by \p key .
+ * @param self A pointer to the \ref g2l_t instance in which to search.
+ * @param key A pointer to the key (see \ref g2l_find_first ).
+ * @param key_size The size, in bytes, of the key (see \ref g2l_find_first ).
+ * @return \ref size_t The number of matching elements.
+ * @see g2l_find_first, g2l_remove_if_key
+ */
+G2L_INLINE size_t g2l_count_if_key(g2l_t const *self, void const *key, size_t key_size);
+
+/**
+ * @brief A function that can be used to remove all of the elements whose data starts
+ * with the \p key_size bytes pointed to by \p key , in a single pass.
+ * @param self A pointer to the \ref g2l_t instance from which to remove the elements.
+ * @param key A pointer to the key (see \ref g2l_find_first ).
+ * @param key_size The size, in bytes, of the key (see \ref g2l_find_first ).
+ * @return \ref size_t The number of removed elements.
+ * @see g2l_find_first, g2l_count_if_key
+ */
+G2L_INLINE size_t g2l_remove_if_key(g2l_t *self, void const *key, size_t key_size);
+
+/**
+ * @brief An opaque data type representing a read-side critical section on a
+ * list created with \ref g2l_create_concurrent , as returned by \ref g2l_read_begin .
+ * @see g2l_read_begin, g2l_read_next, g2l_read_end
+ */
+typedef struct g2l_reader_t g2l_reader_t;
+
+/**
+ * @brief The function that a reader thread must call before traversing a list created
+ * with \ref g2l_create_concurrent .
+ * @param self A pointer to the concurrent \ref g2l_t instance to be traversed.
+ * @return \ref g2l_reader_t* A pointer to a reader object, which must be passed to
+ * \ref g2l_read_next and then to \ref g2l_read_end , or the \ref NULL pointer if too
+ * many readers (i.e., `G2L_MAX_READERS`, 64 by default) are already active on \p self .
+ * @note - The elements reachable from the returned reader remain valid until
+ * \ref g2l_read_end is called, even if the writer removes them in the meantime.
+ * Read-side critical sections should therefore be kept reasonably short, since they
+ * delay the freeing of the removed elements.
+ * @see g2l_read_next, g2l_read_end
+ */
+G2L_INLINE g2l_reader_t *g2l_read_begin(g2l_t *self);
+
+/**
+ * @brief The function that can be used to retrieve the next element, from oldest to
+ * youngest, of a list being traversed using \p reader .
+ * @param reader A pointer to the reader object returned by \ref g2l_read_begin .
+ * @param data A pointer to memory into which the element's data should be copied.
+ * The \ref NULL pointer can be passed if the data is not needed by the application.
+ * @return \ref bool A boolean value that will be `false` once the end of the list has
+ * been reached, else `true`.
+ * @note - This function takes no lock and performs no atomic read-modify-write operation.
+ * @note - The traversal is not a frozen snapshot: elements pushed by the writer during the
+ * traversal may be visited, and elements removed during the traversal may or may not be
+ * visited, but the elements visited are always in order and never freed memory.
+ * @see g2l_read_begin, g2l_read_end
+ */
+G2L_INLINE bool g2l_read_next(g2l_reader_t *reader, void *data);
+
+/**
+ * @brief The function that a reader thread must call once it is done traversing a list.
+ * @param reader A pointer to the reader object returned by \ref g2l_read_begin ,
+ * which must not be used anymore after this call.
+ * @see g2l_read_begin
+ */
+G2L_INLINE void g2l_read_end(g2l_reader_t *reader);
+
+/**
+ * @brief A function that the writer can call to free the removed elements of a list created
+ * with \ref g2l_create_concurrent that are no longer reachable by any reader.
+ * @param self A pointer to the concurrent \ref g2l_t instance.
+ * @return \ref size_t The number of elements that were freed.
+ * @note - This function is also called automatically every `G2L_RECLAIM_THRESHOLD` (64 by
+ * default) removals, so calling it explicitly is only useful to release memory sooner
+ * (e.g., after a burst of removals followed by a quiet period).
+ * @note - Like the other functions that modify the list, this function must only be called
+ * by the writer.
+ */
+G2L_INLINE size_t g2l_reclaim(g2l_t *self);
+
+/**
+ * @brief The type of the (optional) function called by \ref g2l_expire for each
+ * evicted element, right before that element is freed.
+ * @param data A pointer to the evicted element's data (or the \ref NULL pointer
+ * for `data_size = 0`), which is only valid for the duration of the call.
+ * @param timestamp The time (see \ref g2l_now ) at which the element was inserted.
+ * @param context The \p context pointer that was passed to \ref g2l_expire .
+ */
+typedef void (*g2l_expire_callback_t)(void const *data, uint64_t timestamp, void *context);
+
+/**
+ * @brief A function that returns the current time, in nanoseconds, of the
+ * monotonic clock used to timestamp the elements of lists created with
+ * \ref g2l_create_ttl .
+ * @return \ref uint64_t The current time, in nanoseconds, of the monotonic clock.
+ */
+G2L_INLINE uint64_t g2l_now(void);
+
+/**
+ * @brief The function that can be used to evict, in a single batched pass, the expired
+ * elements of a list created with \ref g2l_create_ttl .
+ * @param self A pointer to the \ref g2l_t instance (in TTL mode) from which to evict
+ * the expired elements.
+ * @param now The current time (see \ref g2l_now ). Elements inserted at time `t`
+ * are evicted if `now - t >= ttl` (elements inserted after \p now are never evicted).
+ * @param max The maximum number of elements to be evicted. \ref SIZE_MAX can be
+ * passed to evict all of the expired elements.
+ * @param callback An optional function (i.e., can be \ref NULL ) that will be called
+ * for each evicted element, from oldest to youngest.
+ * @param context An arbitrary pointer passed as is to \p callback .
+ * @return \ref size_t The number of evicted elements.
+ * @note - Elements are evicted from the oldest end of the list (i.e., the end used by
+ * \ref g2l_shift ), and the operation stops at the first element that has not expired,
+ * so the live elements are never touched.
+ * @note - Calling this function on a list that was not created using \ref g2l_create_ttl
+ * is a programming error.
+ * @see g2l_next_expiry
+ */
+G2L_INLINE size_t g2l_expire(g2l_t *self, uint64_t now, size_t max, g2l_expire_callback_t callback, void *context);
+
+/**
+ * @brief A function that can be used to retrieve the time at which the oldest element
+ * of a list created with \ref g2l_create_ttl will expire, which is useful to schedule
+ * the next call to \ref g2l_expire .
+ * @param self A pointer to the \ref g2l_t instance (in TTL mode).
+ * @param expiry A pointer to memory into which the expiry time (see \ref g2l_now ) of the
+ * oldest element will be written.
+ * @return \ref bool A boolean value that will be `false` if the list is empty (in which case
+ * \p expiry is left untouched), else `true`.
+ * @note - The expiry time saturates at \ref UINT64_MAX (e.g., for very large TTLs).
+ * @note - This is an `O(1)` operation.
+ * @note - Calling this function on a list that was not created using \ref g2l_create_ttl
+ * is a programming error.
+ * @see g2l_expire
+ */
+G2L_INLINE bool g2l_next_expiry(g2l_t const *self, uint64_t *expiry);
+
+/**
+ * @brief An opaque data type used as a container for a **sharded multi-lane queue**,
+ * which internally holds several independent linked lists (i.e., "lanes"), each
+ * protected by its own lock, and which must be instantiated using the
+ * \ref g2l_sharded_create function.
+ * @note - Unlike \ref g2l_t , this type is thread-safe: producers and consumers
+ * may call \ref g2l_sharded_enqueue , \ref g2l_sharded_enqueue_key ,
+ * \ref g2l_sharded_dequeue and \ref g2l_sharded_dequeue_batch concurrently
+ * from any number of threads.
+ * @note - Each lane is FIFO, but there is no global FIFO ordering across lanes.
+ * Elements that must be dequeued in the order in which they were enqueued should
+ * be enqueued using \ref g2l_sharded_enqueue_key with the same key.
+ * @see g2l_sharded_create, g2l_sharded_destroy
+ * @par Example:
+ * @include examples/sharded_benchmark.c
+ */
+typedef struct g2l_sharded_t g2l_sharded_t;
+
+/**
+ * @brief The function that must be used to instantiate a new sharded multi-lane
+ * queue object (i.e., \ref g2l_sharded_t ).
+ * @param data_size The size, in bytes, of the data type that will be
+ * stored in the created instance.
+ * @param lanes The number of internal lanes (i.e., independent lists). A value of
+ * `0` is a programming error. Using roughly one lane per producer or consumer
+ * thread is a good starting point.
+ * @param abort_on_enomem Whether \ref ENOMEM errors should result in
+ * the process being aborted (`true`) or whether the function should
+ * simply return the \ref NULL pointer and let the application deal
+ * with the error.
+ * @return \ref g2l_sharded_t* A pointer to the created sharded queue object.
+ * @note - See \ref g2l_create for a discussion about \p abort_on_enomem , which
+ * applies in the same way to \ref g2l_sharded_enqueue and \ref g2l_sharded_enqueue_key .
+ * @see g2l_sharded_destroy
+ */
+G2L_INLINE g2l_sharded_t *g2l_sharded_create(size_t data_size, size_t lanes, bool abort_on_enomem);
+
+/**
+ * @brief The function that should be used to destroy a sharded queue object
+ * once it is no longer needed by the application.
+ * @param self A pointer to the \ref g2l_sharded_t instance to be destroyed.
+ * @note - No other thread may be using \p self when this function is called.
+ * @see g2l_sharded_create
+ */
+G2L_INLINE void g2l_sharded_destroy(g2l_sharded_t *self);
+
+/**
+ * @brief A function that can be used to retrieve the number of lanes
+ * of the sharded queue object \p self .
+ * @param self A pointer to the \ref g2l_sharded_t object.
+ * @return \ref size_t The number of lanes, as specified when calling \ref g2l_sharded_create .
+ */
+G2L_INLINE size_t g2l_sharded_lanes(g2l_sharded_t const *self);
+
+/**
+ * @brief A function that can be used to retrieve the total number of elements
+ * contained in all of the lanes of the sharded queue object \p self .
+ * @param self A pointer to the \ref g2l_sharded_t object.
+ * @return \ref size_t The number of elements in \p self .
+ * @note - While other threads are enqueuing or dequeuing, the returned value
+ * is only an approximation, since the lanes are not all locked at once.
+ */
+G2L_INLINE size_t g2l_sharded_size(g2l_sharded_t const *self);
+
+/**
+ * @brief The function that can be used to enqueue a new element into the
+ * calling thread's "home" lane.
+ * @param self A pointer to the \ref g2l_sharded_t instance into which to enqueue
+ * the new element.
+ * @param data A pointer to arbitrary memory of size defined when instantiating
+ * the object using \ref g2l_sharded_create , which is to be copied and stored
+ * inside \p self .
+ * @return \ref int An integer value that will be `0` if the new element was successfully
+ * added, else it will be \ref ENOMEM .
+ * @note - Each thread is assigned a home lane (in a round-robin fashion) the first time it
+ * enqueues into any sharded queue, so that producer threads spread evenly across the lanes.
+ * Consumer threads are numbered separately (see \ref g2l_sharded_dequeue_batch ), so
+ * that the n-th consumer thread's home lane is the n-th producer thread's home lane.
+ * @see g2l_sharded_enqueue_key
+ */
+G2L_INLINE int g2l_sharded_enqueue(g2l_sharded_t *self, void const *data);
+
+/**
+ * @brief The function that can be used to enqueue a new element into the lane
+ * associated with \p key .
+ * @param self A pointer to the \ref g2l_sharded_t instance into which to enqueue
+ * the new element.
+ * @param key An arbitrary application defined key (e.g., a session identifier).
+ * All of the elements enqueued with the same key go to the same lane, which means
+ * that they will be dequeued in the order in which they were enqueued.
+ * @param data A pointer to arbitrary memory of size defined when instantiating
+ * the object using \ref g2l_sharded_create , which is to be copied and stored
+ * inside \p self .
+ * @return \ref int An integer value that will be `0` if the new element was successfully
+ * added, else it will be \ref ENOMEM .
+ * @see g2l_sharded_enqueue
+ */
+G2L_INLINE int g2l_sharded_enqueue_key(g2l_sharded_t *self, uint64_t key, void const *data);
+
+/**
+ * @brief The function that can be used to dequeue a single element from
+ * the sharded queue object \p self .
+ * @param self A pointer to the \ref g2l_sharded_t instance from which to dequeue
+ * an element.
+ * @param data A pointer to memory into which the dequeued element's data should be copied.
+ * The \ref NULL pointer can be passed if the data is not needed by the application.
+ * @return \ref bool A boolean value indicating whether an element was dequeued. A
+ * `false` value means that all of the lanes were found empty.
+ * @note - The calling thread's home lane is inspected first, after which the
+ * other lanes are visited (i.e., "stolen" from) in order.
+ * @see g2l_sharded_dequeue_batch
+ */
+G2L_INLINE bool g2l_sharded_dequeue(g2l_sharded_t *self, void *data);
+
+/**
+ * @brief The function that can be used to dequeue up to \p max elements from the
+ * sharded queue object \p self , taking each lane's lock only once.
+ * @param self A pointer to the \ref g2l_sharded_t instance from which to dequeue
+ * the elements.
+ * @param data A pointer to an array of at least \p max elements of the size defined
+ * when instantiating \p self , into which the dequeued elements' data will be copied,
+ * in dequeuing order. The \ref NULL pointer can be passed if the data is not needed
+ * by the application.
+ * @param max The maximum number of elements to be dequeued.
+ * @return \ref size_t The number of elements that were dequeued, which will be `0`
+ * if all of the lanes were found empty.
+ * @note - The calling thread's home lane is drained first, and the remaining capacity
+ * is then filled by stealing batches from the other lanes. Since each batch is taken
+ * from the oldest end of a lane while holding that lane's lock, per-key FIFO ordering
+ * (see \ref g2l_sharded_enqueue_key ) is preserved.
+ * @see g2l_sharded_dequeue
+ */
+G2L_INLINE size_t g2l_sharded_dequeue_batch(g2l_sharded_t *self, void *data, size_t max);
+
+#ifdef G2L_HEADER_ONLY
+#include "g2l.c"
+#endif
 
 #endif
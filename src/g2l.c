@@ -21,10 +21,18 @@
     THE SOFTWARE.
 */
 
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L // For `clock_gettime` when compiling with -std=c17
+#endif
+
 #include <errno.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 #include "g2l.h"
 
@@ -32,75 +40,344 @@
 #define G2L_SRC_FILE_NAME "g2l.c"
 #endif
 
+#ifndef G2L_SKIP_MAX_LEVEL
+#define G2L_SKIP_MAX_LEVEL (16) // With p = 1/4, good for up to ~4^16 elements
+#endif
+
+#ifndef G2L_FINGER_MAX_WALK
+#define G2L_FINGER_MAX_WALK (16) // Beyond this distance, indexed lists use the skip list instead of walking
+#endif
+
+#ifndef G2L_SCAN_BATCH
+#define G2L_SCAN_BATCH (8) // Number of nodes whose data is prefetched together when scanning
+#endif
+
+#ifndef G2L_MAX_READERS
+#define G2L_MAX_READERS (64) // Maximum number of concurrent readers per concurrent list
+#endif
+
+#ifndef G2L_RECLAIM_THRESHOLD
+#define G2L_RECLAIM_THRESHOLD (64) // Number of retired nodes after which reclamation is attempted
+#endif
+
+#ifndef G2L_CACHE_LINE_SIZE
+#define G2L_CACHE_LINE_SIZE (64)
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define G2L_PREFETCH(address) __builtin_prefetch(address)
+#else
+#define G2L_PREFETCH(address) ((void)(address))
+#endif
+
+// NOTE: Readers of concurrent lists (see `g2l_read_next`) traverse `tail` and `previous`
+// without any lock, so every store to those must be a release store, and the readers'
+// loads must be acquire loads. On x86-64, both compile to plain moves.
+#define G2L_PUBLISH(lvalue, value) __atomic_store_n(&(lvalue), (value), __ATOMIC_RELEASE)
+#define G2L_LOAD(lvalue) __atomic_load_n(&(lvalue), __ATOMIC_ACQUIRE)
+
 #define LIBRARY_ERROR_PREFIX "[library error]"         // An actual error in the library implementation
 #define PROGRAMMING_ERROR_PREFIX "[programming error]" // An programming error (i.e, made by the application using the library)
 
-static void *g2l_pop_internal(g2l_t *self);
-static void *g2l_shift_internal(g2l_t *self);
+#if defined(__GNUC__) || defined(__clang__)
+#define G2L_LIKELY(condition) __builtin_expect(!!(condition), 1)
+#define G2L_UNLIKELY(condition) __builtin_expect(!!(condition), 0)
+#define G2L_COLD __attribute__((cold, noinline))
+#define G2L_NOINLINE __attribute__((noinline))
+#else
+#define G2L_LIKELY(condition) (condition)
+#define G2L_UNLIKELY(condition) (condition)
+#define G2L_COLD
+#define G2L_NOINLINE
+#endif
+
+// NOTE: Programming errors (i.e., invalid arguments) are only checked when NDEBUG is not
+// defined. The condition is kept in the expression so that it still gets type-checked.
+#ifdef NDEBUG
+#define G2L_CHECK(condition) (0 && (condition))
+#else
+#define G2L_CHECK(condition) G2L_UNLIKELY(condition)
+#endif
 
-struct my_node
+// NOTE: `next` points toward the oldest element (i.e., the tail) and `previous` toward
+// the youngest one (i.e., the head). Positional indices start at the tail (index 0),
+// so walking toward increasing indices means following `previous`.
+struct g2l_node
 {
     void *data;
-    struct my_node *previous;
-    struct my_node *next;
+    struct g2l_node *previous;
+    struct g2l_node *next;
+};
+
+// NOTE: TTL, indexed and concurrent lists (which are mutually exclusive) allocate this larger
+// node instead, so that plain lists do not pay for per-node metadata. `node` must remain the
+// first member (see `g2l_extended`).
+struct g2l_extended_node
+{
+    struct g2l_node node;
+    union
+    {
+        uint64_t timestamp;           // Insertion time (TTL mode), or retirement epoch once retired (concurrent mode)
+        struct g2l_skip_tower *tower; // Skip list tower (indexed mode, only for some nodes, NULL otherwise)
+    };
+};
+
+// NOTE: The linked list itself acts as the skip list's bottom level, so towers only
+// hold the levels above it. `width` is the number of positions between a tower and
+// its `next` tower at the same level (unused when `next` is NULL). `back` points to the
+// tower whose `next` is this one, so that the last element can be removed without a search.
+struct g2l_skip_link
+{
+    struct g2l_skip_tower *next;
+    struct g2l_skip_tower *back; // Unused for the header
+    size_t width;
+};
+
+struct g2l_skip_tower
+{
+    struct g2l_node *node; // NULL for the header
+    size_t levels;
+    struct g2l_skip_link links[];
 };
 
 struct g2l_t
 {
     size_t n;
     size_t data_size;
-    struct my_node *head;
-    struct my_node *tail;
+    struct g2l_node *head;
+    struct g2l_node *tail;
+    size_t node_size; // Either `sizeof(struct g2l_node)` or `sizeof(struct g2l_extended_node)`
+    bool abort_on_enomem;
+    bool ttl_mode;
+    uint64_t ttl;
+    struct g2l_node *finger; // Cached cursor for positional access (NULL if invalidated)
+    size_t finger_index;
+    struct g2l_skip_tower *skip; // Skip list header (only for indexed lists)
+    uint64_t skip_state;        // PRNG state used to pick the height of new towers
+    g2l_compare_t compare;      // Ordering of the elements (only for sorted lists)
+    struct g2l_rcu *rcu;         // Reader slots and retired nodes (only for concurrent lists)
+};
+
+struct g2l_reader_t
+{
+    _Alignas(G2L_CACHE_LINE_SIZE) uint64_t epoch; // Epoch observed by `g2l_read_begin`, or 0 when not reading
+    bool in_use;
+    bool started;
+    g2l_t const *list;
+    struct g2l_node *cursor;
+};
+
+// NOTE: Nodes removed from a concurrent list are "retired" (i.e., chained, oldest first,
+// through their `next` pointer, which readers never follow) and tagged with the current
+// epoch. They are only freed once every reader that was active at that epoch has called
+// `g2l_read_end`.
+struct g2l_rcu
+{
+    uint64_t epoch;
+    struct g2l_node *retired_head;
+    struct g2l_node *retired_tail;
+    size_t n_retired;
+    g2l_reader_t readers[G2L_MAX_READERS];
+};
+
+// NOTE: Each lane is aligned on its own cache line(s), so that threads working
+// on different lanes never contend for the same line (i.e., no false sharing).
+struct g2l_lane
+{
+    _Alignas(G2L_CACHE_LINE_SIZE) pthread_mutex_t lock;
+    size_t n; // Mirror of `list.n` that can be read without taking `lock`
+    g2l_t list;
+};
+
+struct g2l_sharded_t
+{
+    size_t n_lanes;
+    size_t data_size;
     bool abort_on_enomem;
+    struct g2l_lane *lanes;
 };
 
+// NOTE: Each thread gets a "home" lane index the first time it enqueues into (or dequeues
+// from) a sharded queue. Producers and consumers are numbered separately, so that the i-th
+// consumer's home lane is the i-th producer's home lane, whatever order the threads start in.
+static _Thread_local size_t g2l_thread_producer_lane = SIZE_MAX;
+static _Thread_local size_t g2l_thread_consumer_lane = SIZE_MAX;
+static size_t g2l_next_producer_lane = 0;
+static size_t g2l_next_consumer_lane = 0;
+
+static void g2l_init(g2l_t *self, size_t data_size, bool abort_on_enomem);
+static int g2l_node_create(g2l_t *self, void const *data, struct g2l_node **output);
+static void g2l_push_internal(g2l_t *self, struct g2l_node *node);
+G2L_COLD _Noreturn static void g2l_programming_error(char const *func, int line, char const *format, ...);
+G2L_COLD _Noreturn static void g2l_library_error(char const *format, ...);
+G2L_COLD static void g2l_enomem_error(bool abort_on_enomem);
+static struct g2l_node *g2l_pop_internal(g2l_t *self);
+static struct g2l_node *g2l_shift_internal(g2l_t *self);
+static void g2l_node_free(g2l_t *self, struct g2l_node *node);
+static inline struct g2l_extended_node *g2l_extended(struct g2l_node *node);
+G2L_NOINLINE static int g2l_node_init_extended(g2l_t *self, struct g2l_node *node);
+static inline void g2l_assert_concurrent(g2l_t const *self, char const *func);
+static void g2l_link_at(g2l_t *self, struct g2l_node *node, size_t index);
+static void g2l_link_before(g2l_t *self, struct g2l_node *node, struct g2l_node *younger, size_t index);
+static void g2l_unlink(g2l_t *self, struct g2l_node *node, size_t index);
+static struct g2l_node *g2l_node_at(g2l_t *self, size_t index);
+static size_t g2l_skip_random_levels(g2l_t *self);
+static void g2l_skip_locate(g2l_t const *self, size_t index, struct g2l_skip_tower **update, size_t *rank);
+static void g2l_skip_insert(g2l_t *self, struct g2l_node *node, size_t index);
+static void g2l_skip_remove(g2l_t *self, struct g2l_node *node, size_t index);
+static struct g2l_node *g2l_skip_find(g2l_t const *self, size_t index);
+static size_t g2l_skip_bound(g2l_t const *self, void const *key, bool upper, struct g2l_node **output);
+static inline void g2l_assert_not_sorted(g2l_t const *self, char const *func);
+static inline void g2l_assert_key_size(g2l_t const *self, size_t key_size, char const *func);
+static struct g2l_node *g2l_scan_key(struct g2l_node *node, size_t *index, void const *key, size_t key_size);
+static inline void g2l_assert_sorted(g2l_t const *self, char const *func);
+static inline void g2l_assert_ttl_mode(g2l_t const *self, char const *func);
+static size_t g2l_sharded_home_lane(g2l_sharded_t const *self, size_t *thread_lane, size_t *next_lane);
+static size_t g2l_sharded_drain_lane(g2l_sharded_t *self, struct g2l_lane *lane, char *data, size_t max);
+
 g2l_t *g2l_create(size_t data_size, bool abort_on_enomem)
 {
     g2l_t *self = malloc(sizeof(g2l_t));
     if (self == NULL)
     {
-        if (abort_on_enomem)
-        {
-            perror("malloc()");
-            abort();
-        }
-        if (errno != ENOMEM) // Based on my understanding, this should not be possible.
-        {
-            fprintf(stderr, "%s Oups... Expecting errno to contain '%s' but contains '%s'\n", LIBRARY_ERROR_PREFIX, strerror(ENOMEM), strerror(errno));
-            abort();
-        }
+        g2l_enomem_error(abort_on_enomem);
         return NULL;
     }
-    self->data_size = data_size;
-    self->abort_on_enomem = abort_on_enomem;
-    self->n = 0;
-    self->head = NULL;
-    self->tail = NULL;
+    g2l_init(self, data_size, abort_on_enomem);
+    return self;
+}
+
+g2l_t *g2l_create_ttl(size_t data_size, uint64_t ttl, bool abort_on_enomem)
+{
+    g2l_t *self = g2l_create(data_size, abort_on_enomem);
+    if (self == NULL)
+    {
+        return NULL;
+    }
+    self->node_size = sizeof(struct g2l_extended_node);
+    self->ttl_mode = true;
+    self->ttl = ttl;
+    return self;
+}
+
+g2l_t *g2l_create_indexed(size_t data_size, bool abort_on_enomem)
+{
+    g2l_t *self = g2l_create(data_size, abort_on_enomem);
+    if (self == NULL)
+    {
+        return NULL;
+    }
+    size_t size = sizeof(struct g2l_skip_tower) + G2L_SKIP_MAX_LEVEL * sizeof(struct g2l_skip_link);
+    self->skip = malloc(size);
+    if (self->skip == NULL)
+    {
+        g2l_enomem_error(abort_on_enomem);
+        free(self);
+        errno = ENOMEM;
+        return NULL;
+    }
+    self->node_size = sizeof(struct g2l_extended_node);
+    self->skip->node = NULL;
+    self->skip->levels = G2L_SKIP_MAX_LEVEL;
+    for (size_t i = 0; i < G2L_SKIP_MAX_LEVEL; i++)
+    {
+        self->skip->links[i].next = NULL;
+        self->skip->links[i].back = NULL;
+        self->skip->links[i].width = 0;
+    }
+    return self;
+}
+
+g2l_t *g2l_create_sorted(size_t data_size, g2l_compare_t compare, bool abort_on_enomem)
+{
+    if (G2L_CHECK(data_size == 0 || compare == NULL))
+    {
+        g2l_programming_error(__func__, __LINE__, "expecting 'data_size > 0' and 'compare' argument not to be NULL");
+    }
+    g2l_t *self = g2l_create_indexed(data_size, abort_on_enomem);
+    if (self == NULL)
+    {
+        return NULL;
+    }
+    self->compare = compare;
+    return self;
+}
+
+g2l_t *g2l_create_concurrent(size_t data_size, bool abort_on_enomem)
+{
+    g2l_t *self = g2l_create(data_size, abort_on_enomem);
+    if (self == NULL)
+    {
+        return NULL;
+    }
+    self->rcu = aligned_alloc(G2L_CACHE_LINE_SIZE, sizeof(struct g2l_rcu));
+    if (self->rcu == NULL)
+    {
+        g2l_enomem_error(abort_on_enomem);
+        free(self);
+        errno = ENOMEM;
+        return NULL;
+    }
+    self->node_size = sizeof(struct g2l_extended_node);
+    self->rcu->epoch = 1;
+    self->rcu->retired_head = NULL;
+    self->rcu->retired_tail = NULL;
+    self->rcu->n_retired = 0;
+    for (size_t i = 0; i < G2L_MAX_READERS; i++)
+    {
+        g2l_reader_t *reader = &self->rcu->readers[i];
+        reader->epoch = 0;
+        reader->in_use = false;
+        reader->started = false;
+        reader->list = self;
+        reader->cursor = NULL;
+    }
     return self;
 }
 
 void g2l_clear(g2l_t *self)
 {
-    struct my_node *tmp;
-    while ((tmp = self->head) != NULL)
+    // NOTE: The list is detached first, so that no new reader can reach the nodes being released.
+    struct g2l_node *tmp = self->head;
+    self->head = NULL;
+    G2L_PUBLISH(self->tail, NULL);
+    while (tmp != NULL)
     {
-        self->head = tmp->next;
-        free(tmp->data);
-        free(tmp);
+        struct g2l_node *next = tmp->next;
+        g2l_node_free(self, tmp);
         self->n -= 1;
+        tmp = next;
     }
-    if (self->n != 0)
+    if (G2L_UNLIKELY(self->n != 0))
     {
-        fprintf(stderr, "%s Oups... Something is wrong. This should not be possible.\n", LIBRARY_ERROR_PREFIX);
-        abort();
+        g2l_library_error("Oups... Something is wrong. This should not be possible.");
+    }
+    self->finger = NULL;
+    if (self->skip != NULL)
+    {
+        for (size_t i = 0; i < G2L_SKIP_MAX_LEVEL; i++)
+        {
+            self->skip->links[i].next = NULL;
+            self->skip->links[i].width = 0;
+        }
     }
-    self->head = NULL;
-    self->tail = NULL;
 }
 
 void g2l_destroy(g2l_t *self)
 {
     g2l_clear(self);
+    if (self->rcu != NULL)
+    {
+        struct g2l_node *tmp;
+        while ((tmp = self->rcu->retired_head) != NULL)
+        {
+            self->rcu->retired_head = tmp->next;
+            free(tmp->data);
+            free(tmp);
+        }
+        free(self->rcu);
+    }
+    free(self->skip);
     free(self);
 }
 
@@ -111,168 +388,1194 @@ size_t g2l_size(g2l_t const *self)
 
 int g2l_push(g2l_t *self, void const *data)
 {
-    if (self->data_size == 0 && data != NULL)
+    g2l_assert_not_sorted(self, __func__);
+    struct g2l_node *node;
+    int error = g2l_node_create(self, data, &node);
+    if (error != 0)
     {
-        fprintf(stderr, "[file:%s][line:%i] %s %s 'data' argument should be NULL when 'data_size = 0'\n", G2L_SRC_FILE_NAME, __LINE__, __func__, PROGRAMMING_ERROR_PREFIX);
-        abort();
+        return error;
     }
-    if (self->data_size > 0 && data == NULL)
+    g2l_push_internal(self, node);
+    return 0;
+}
+
+bool g2l_pop(g2l_t *self, void *data)
+{
+    if (G2L_CHECK(self->data_size == 0 && data != NULL))
     {
-        fprintf(stderr, "[file:%s][line:%i] %s %s 'data' argument should not be NULL because 'data_size = %zu'\n", G2L_SRC_FILE_NAME, __LINE__, __func__, PROGRAMMING_ERROR_PREFIX, self->data_size);
-        abort();
+        g2l_programming_error(__func__, __LINE__, "expecting 'data' argument to be NULL pointer for 'data_size = 0'");
     }
-    struct my_node *node = malloc(sizeof(struct my_node));
-    if (node == NULL)
+    if (self->n == 0)
     {
-        if (self->abort_on_enomem)
-        {
-            perror("malloc()");
-            abort();
-        }
-        if (errno != ENOMEM) // Based on my understanding, this should not be possible.
-        {
-            fprintf(stderr, "%s Oups... Expecting errno to contain '%s' but contains '%s'\n", LIBRARY_ERROR_PREFIX, strerror(ENOMEM), strerror(errno));
-            abort();
-        }
-        return errno;
+        return false;
     }
-    node->previous = NULL;
-    node->next = NULL;
-    node->data = NULL;
-    if (self->data_size > 0)
+    struct g2l_node *tmp = g2l_pop_internal(self);
+    if (data != NULL)
     {
-        node->data = malloc(self->data_size);
-        if (node->data == NULL)
-        {
-            if (self->abort_on_enomem)
-            {
-                perror("malloc()");
-                abort();
-            }
-            if (errno != ENOMEM) // Based on my understanding, this should not be possible.
-            {
-                fprintf(stderr, "%s Oups... Expecting errno to contain '%s' but contains '%s'\n", LIBRARY_ERROR_PREFIX, strerror(ENOMEM), strerror(errno));
-                abort();
-            }
-            free(node);
-            return errno;
-        }
-        memcpy(node->data, data, self->data_size);
+        memcpy(data, tmp->data, self->data_size);
+    }
+    g2l_node_free(self, tmp);
+    return true;
+}
+
+bool g2l_shift(g2l_t *self, void *data)
+{
+    if (G2L_CHECK(self->data_size == 0 && data != NULL))
+    {
+        g2l_programming_error(__func__, __LINE__, "expecting 'data' argument to be NULL pointer for 'data_size = 0'");
     }
     if (self->n == 0)
     {
-        self->head = node;
-        self->tail = node;
+        return false;
     }
-    else
+    struct g2l_node *tmp = g2l_shift_internal(self);
+    if (data != NULL)
     {
-        struct my_node *tmp = self->head;
-        tmp->previous = node;
-        self->head = node;
-        self->head->next = tmp;
+        memcpy(data, tmp->data, self->data_size);
     }
-    self->n += 1;
-    return 0;
+    g2l_node_free(self, tmp);
+    return true;
 }
 
-bool g2l_pop(g2l_t *self, void *data)
+bool g2l_enqueue(g2l_t *self, void const *data)
+{
+    return g2l_push(self, data);
+}
+
+bool g2l_dequeue(g2l_t *self, void *data)
+{
+    return g2l_shift(self, data);
+}
+
+bool g2l_at(g2l_t *self, size_t index, void *data)
 {
-    if (self->data_size == 0 && data != NULL)
+    if (G2L_CHECK(self->data_size == 0 && data != NULL))
     {
-        fprintf(stderr, "[file:%s][line:%i] %s %s expecting 'data' argument to be NULL pointer for 'data_size = 0'\n", G2L_SRC_FILE_NAME, __LINE__, __func__, PROGRAMMING_ERROR_PREFIX);
-        abort();
+        g2l_programming_error(__func__, __LINE__, "expecting 'data' argument to be NULL pointer for 'data_size = 0'");
     }
-    if (self->n == 0)
+    if (index >= self->n)
     {
         return false;
     }
-    void *tmp = g2l_pop_internal(self);
+    struct g2l_node *node = g2l_node_at(self, index);
     if (data != NULL)
     {
-        memcpy(data, tmp, self->data_size);
+        memcpy(data, node->data, self->data_size);
     }
-    if (tmp != NULL)
+    return true;
+}
+
+int g2l_insert_at(g2l_t *self, size_t index, void const *data)
+{
+    g2l_assert_not_sorted(self, __func__);
+    if (G2L_CHECK(index > self->n))
     {
-        free(tmp);
+        g2l_programming_error(__func__, __LINE__, "'index = %zu' is out of range for 'n = %zu'", index, self->n);
     }
-    return true;
+    // NOTE: `g2l_expire` relies on the elements being ordered by insertion time.
+    if (G2L_CHECK(self->ttl_mode && index != self->n))
+    {
+        g2l_programming_error(__func__, __LINE__, "list was created using 'g2l_create_ttl' (only 'index = n' is allowed)");
+    }
+    struct g2l_node *node;
+    int error = g2l_node_create(self, data, &node);
+    if (error != 0)
+    {
+        return error;
+    }
+    g2l_link_at(self, node, index);
+    return 0;
 }
 
-bool g2l_shift(g2l_t *self, void *data)
+bool g2l_remove_at(g2l_t *self, size_t index, void *data)
 {
-    if (self->data_size == 0 && data != NULL)
+    if (G2L_CHECK(self->data_size == 0 && data != NULL))
     {
-        fprintf(stderr, "[file:%s][line:%i] %s %s expecting 'data' argument to be NULL pointer for 'data_size = 0'\n", G2L_SRC_FILE_NAME, __LINE__, __func__, PROGRAMMING_ERROR_PREFIX);
-        abort();
+        g2l_programming_error(__func__, __LINE__, "expecting 'data' argument to be NULL pointer for 'data_size = 0'");
     }
-    if (self->n == 0)
+    if (index >= self->n)
     {
         return false;
     }
-    void *tmp = g2l_shift_internal(self);
+    struct g2l_node *node = g2l_node_at(self, index);
+    g2l_unlink(self, node, index);
     if (data != NULL)
     {
-        memcpy(data, tmp, self->data_size);
+        memcpy(data, node->data, self->data_size);
+    }
+    g2l_node_free(self, node);
+    return true;
+}
+
+int g2l_insert_sorted(g2l_t *self, void const *data)
+{
+    g2l_assert_sorted(self, __func__);
+    struct g2l_node *node;
+    int error = g2l_node_create(self, data, &node);
+    if (error != 0)
+    {
+        return error;
     }
-    if (tmp != NULL)
+    // NOTE: Inserting after the elements that compare equal keeps the insertion stable.
+    struct g2l_node *younger;
+    size_t index = g2l_skip_bound(self, data, true, &younger);
+    if (younger == NULL)
     {
-        free(tmp);
+        g2l_push_internal(self, node);
+    }
+    else
+    {
+        g2l_link_before(self, node, younger, index);
+    }
+    return 0;
+}
+
+bool g2l_find(g2l_t *self, void const *key, void *data)
+{
+    g2l_assert_sorted(self, __func__);
+    struct g2l_node *node;
+    size_t index = g2l_skip_bound(self, key, false, &node);
+    if (node == NULL || self->compare(node->data, key) != 0)
+    {
+        return false;
+    }
+    self->finger = node;
+    self->finger_index = index;
+    if (data != NULL)
+    {
+        memcpy(data, node->data, self->data_size);
     }
     return true;
 }
 
-bool g2l_enqueue(g2l_t *self, void const *data)
+size_t g2l_lower_bound(g2l_t *self, void const *key)
 {
-    return g2l_push(self, data);
+    g2l_assert_sorted(self, __func__);
+    struct g2l_node *node;
+    size_t index = g2l_skip_bound(self, key, false, &node);
+    if (node != NULL)
+    {
+        self->finger = node;
+        self->finger_index = index;
+    }
+    return index;
 }
 
-bool g2l_dequeue(g2l_t *self, void *data)
+size_t g2l_upper_bound(g2l_t *self, void const *key)
 {
-    return g2l_shift(self, data);
+    g2l_assert_sorted(self, __func__);
+    struct g2l_node *node;
+    size_t index = g2l_skip_bound(self, key, true, &node);
+    if (node != NULL)
+    {
+        self->finger = node;
+        self->finger_index = index;
+    }
+    return index;
 }
 
-static void *g2l_pop_internal(g2l_t *self)
+bool g2l_find_first(g2l_t *self, void const *key, size_t key_size, size_t *index, void *data)
 {
-    if (self->n == 0)
+    g2l_assert_key_size(self, key_size, __func__);
+    size_t position = 0;
+    struct g2l_node *node = g2l_scan_key(self->tail, &position, key, key_size);
+    if (node == NULL)
     {
-        fprintf(stderr, "%s g2l_pop_internal() should not be called for 'self->n = 0'\n", LIBRARY_ERROR_PREFIX);
-        abort();
+        return false;
     }
-    struct my_node *tmp = self->head;
-    self->head = tmp->next;
-    if (self->head != NULL)
+    self->finger = node;
+    self->finger_index = position;
+    if (index != NULL)
     {
-        self->head->previous = NULL;
+        *index = position;
     }
-    self->n -= 1;
-    void *data = tmp->data;
-    free(tmp);
-    if (self->n == 0)
+    if (data != NULL)
     {
-        self->tail = NULL;
+        memcpy(data, node->data, self->data_size);
     }
-    return data;
+    return true;
 }
 
-static void *g2l_shift_internal(g2l_t *self)
+size_t g2l_count_if_key(g2l_t const *self, void const *key, size_t key_size)
 {
-    if (self->n == 0)
+    g2l_assert_key_size(self, key_size, __func__);
+    size_t count = 0;
+    size_t position = 0;
+    struct g2l_node *node = self->tail;
+    while ((node = g2l_scan_key(node, &position, key, key_size)) != NULL)
     {
-        fprintf(stderr, "%s g2l_shift_internal() should not be called for 'self->n = 0'\n", LIBRARY_ERROR_PREFIX);
-        abort();
+        count += 1;
+        node = node->previous;
+        position += 1;
     }
-    struct my_node *tmp = self->tail;
-    self->tail = tmp->previous;
-    if (self->tail != NULL)
+    return count;
+}
+
+size_t g2l_remove_if_key(g2l_t *self, void const *key, size_t key_size)
+{
+    g2l_assert_key_size(self, key_size, __func__);
+    size_t count = 0;
+    size_t position = 0;
+    struct g2l_node *node = self->tail;
+    while ((node = g2l_scan_key(node, &position, key, key_size)) != NULL)
     {
-        self->tail->next = NULL;
+        struct g2l_node *tmp = node->previous;
+        g2l_unlink(self, node, position);
+        g2l_node_free(self, node);
+        count += 1;
+        node = tmp; // NOTE: `position` stays the same, since the matching node is gone
     }
-    self->n -= 1;
-    void *data = tmp->data;
-    free(tmp);
-    if (self->n == 0)
+    return count;
+}
+
+g2l_reader_t *g2l_read_begin(g2l_t *self)
+{
+    g2l_assert_concurrent(self, __func__);
+    for (size_t i = 0; i < G2L_MAX_READERS; i++)
     {
-        self->head = NULL;
+        g2l_reader_t *reader = &self->rcu->readers[i];
+        bool expected = false;
+        if (__atomic_compare_exchange_n(&reader->in_use, &expected, true, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+        {
+            reader->started = false;
+            reader->cursor = NULL;
+            __atomic_store_n(&reader->epoch, __atomic_load_n(&self->rcu->epoch, __ATOMIC_ACQUIRE), __ATOMIC_RELAXED);
+            // NOTE: Pairs with the fence in `g2l_reclaim`: either the writer sees this reader's
+            // epoch, or this reader sees every unlink that preceded the writer's scan.
+            __atomic_thread_fence(__ATOMIC_SEQ_CST);
+            return reader;
+        }
     }
-    return data;
+    return NULL;
 }
+
+bool g2l_read_next(g2l_reader_t *reader, void *data)
+{
+    if (G2L_CHECK(reader->list->data_size == 0 && data != NULL))
+    {
+        g2l_programming_error(__func__, __LINE__, "expecting 'data' argument to be NULL pointer for 'data_size = 0'");
+    }
+    struct g2l_node *node;
+    if (!reader->started)
+    {
+        node = G2L_LOAD(reader->list->tail);
+        reader->started = true;
+    }
+    else if (reader->cursor != NULL)
+    {
+        node = G2L_LOAD(reader->cursor->previous);
+    }
+    else
+    {
+        return false;
+    }
+    reader->cursor = node;
+    if (node == NULL)
+    {
+        return false;
+    }
+    if (data != NULL)
+    {
+        memcpy(data, node->data, reader->list->data_size);
+    }
+    return true;
+}
+
+void g2l_read_end(g2l_reader_t *reader)
+{
+    __atomic_store_n(&reader->epoch, 0, __ATOMIC_RELEASE);
+    __atomic_store_n(&reader->in_use, false, __ATOMIC_RELEASE);
+}
+
+size_t g2l_reclaim(g2l_t *self)
+{
+    g2l_assert_concurrent(self, __func__);
+    struct g2l_rcu *rcu = self->rcu;
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    uint64_t oldest_epoch = UINT64_MAX;
+    for (size_t i = 0; i < G2L_MAX_READERS; i++)
+    {
+        // NOTE: Acquire pairs with the release in `g2l_read_end`, so that a finished reader's
+        // accesses happen before the nodes it may have visited are freed below.
+        uint64_t tmp = __atomic_load_n(&rcu->readers[i].epoch, __ATOMIC_ACQUIRE);
+        if (tmp != 0 && tmp < oldest_epoch)
+        {
+            oldest_epoch = tmp;
+        }
+    }
+    // NOTE: Readers starting from now on observe an epoch greater than the one of every
+    // node retired so far, and they can no longer reach those nodes.
+    __atomic_store_n(&rcu->epoch, rcu->epoch + 1, __ATOMIC_RELEASE);
+    size_t count = 0;
+    struct g2l_node *tmp;
+    while ((tmp = rcu->retired_head) != NULL && g2l_extended(tmp)->timestamp < oldest_epoch)
+    {
+        rcu->retired_head = tmp->next;
+        free(tmp->data);
+        free(tmp);
+        count += 1;
+    }
+    if (rcu->retired_head == NULL)
+    {
+        rcu->retired_tail = NULL;
+    }
+    rcu->n_retired -= count;
+    return count;
+}
+
+uint64_t g2l_now(void)
+{
+    struct timespec tmp;
+    if (clock_gettime(CLOCK_MONOTONIC, &tmp) != 0)
+    {
+        perror("clock_gettime()");
+        abort();
+    }
+    return (uint64_t)tmp.tv_sec * UINT64_C(1000000000) + (uint64_t)tmp.tv_nsec;
+}
+
+size_t g2l_expire(g2l_t *self, uint64_t now, size_t max, g2l_expire_callback_t callback, void *context)
+{
+    g2l_assert_ttl_mode(self, __func__);
+    // NOTE: First find the oldest live element by walking from the tail (i.e., oldest)...
+    struct g2l_node *tmp = self->tail;
+    size_t count = 0;
+    while (tmp != NULL && count < max)
+    {
+        uint64_t timestamp = g2l_extended(tmp)->timestamp;
+        // NOTE: Written as a difference, since `timestamp + ttl` could overflow for large TTLs.
+        if (timestamp > now || now - timestamp < self->ttl)
+        {
+            break;
+        }
+        tmp = tmp->previous;
+        count += 1;
+    }
+    if (count == 0)
+    {
+        return 0;
+    }
+    if (self->finger != NULL)
+    {
+        if (self->finger_index < count)
+        {
+            self->finger = NULL;
+        }
+        else
+        {
+            self->finger_index -= count;
+        }
+    }
+    // ... then detach the whole expired run at once...
+    struct g2l_node *oldest = self->tail;
+    G2L_PUBLISH(self->tail, tmp);
+    if (tmp == NULL)
+    {
+        self->head = NULL;
+    }
+    else
+    {
+        tmp->next = NULL;
+    }
+    self->n -= count;
+    // ... and finally free it.
+    for (size_t i = 0; i < count; i++)
+    {
+        tmp = oldest;
+        oldest = tmp->previous;
+        if (callback != NULL)
+        {
+            callback(tmp->data, g2l_extended(tmp)->timestamp, context);
+        }
+        g2l_node_free(self, tmp);
+    }
+    return count;
+}
+
+bool g2l_next_expiry(g2l_t const *self, uint64_t *expiry)
+{
+    g2l_assert_ttl_mode(self, __func__);
+    if (self->n == 0)
+    {
+        return false;
+    }
+    uint64_t timestamp = g2l_extended(self->tail)->timestamp;
+    *expiry = self->ttl > UINT64_MAX - timestamp ? UINT64_MAX : timestamp + self->ttl;
+    return true;
+}
+
+g2l_sharded_t *g2l_sharded_create(size_t data_size, size_t lanes, bool abort_on_enomem)
+{
+    if (G2L_CHECK(lanes == 0))
+    {
+        g2l_programming_error(__func__, __LINE__, "'lanes' argument should be greater than 0");
+    }
+    g2l_sharded_t *self = malloc(sizeof(g2l_sharded_t));
+    struct g2l_lane *tmp = aligned_alloc(G2L_CACHE_LINE_SIZE, lanes * sizeof(struct g2l_lane));
+    if (self == NULL || tmp == NULL)
+    {
+        g2l_enomem_error(abort_on_enomem);
+        free(self);
+        free(tmp);
+        errno = ENOMEM;
+        return NULL;
+    }
+    self->n_lanes = lanes;
+    self->data_size = data_size;
+    self->abort_on_enomem = abort_on_enomem;
+    self->lanes = tmp;
+    for (size_t i = 0; i < lanes; i++)
+    {
+        struct g2l_lane *lane = &self->lanes[i];
+        if (G2L_UNLIKELY(pthread_mutex_init(&lane->lock, NULL) != 0))
+        {
+            g2l_library_error("Oups... pthread_mutex_init() failed");
+        }
+        lane->n = 0;
+        g2l_init(&lane->list, data_size, abort_on_enomem);
+    }
+    return self;
+}
+
+void g2l_sharded_destroy(g2l_sharded_t *self)
+{
+    for (size_t i = 0; i < self->n_lanes; i++)
+    {
+        g2l_clear(&self->lanes[i].list);
+        pthread_mutex_destroy(&self->lanes[i].lock);
+    }
+    free(self->lanes);
+    free(self);
+}
+
+size_t g2l_sharded_lanes(g2l_sharded_t const *self)
+{
+    return self->n_lanes;
+}
+
+size_t g2l_sharded_size(g2l_sharded_t const *self)
+{
+    size_t n = 0;
+    for (size_t i = 0; i < self->n_lanes; i++)
+    {
+        n += __atomic_load_n(&self->lanes[i].n, __ATOMIC_RELAXED);
+    }
+    return n;
+}
+
+int g2l_sharded_enqueue(g2l_sharded_t *self, void const *data)
+{
+    struct g2l_lane *lane = &self->lanes[g2l_sharded_home_lane(self, &g2l_thread_producer_lane, &g2l_next_producer_lane)];
+    struct g2l_node *node;
+    // NOTE: The node is allocated before taking the lock to keep the critical section short.
+    int error = g2l_node_create(&lane->list, data, &node);
+    if (error != 0)
+    {
+        return error;
+    }
+    pthread_mutex_lock(&lane->lock);
+    g2l_push_internal(&lane->list, node);
+    __atomic_store_n(&lane->n, lane->list.n, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&lane->lock);
+    return 0;
+}
+
+int g2l_sharded_enqueue_key(g2l_sharded_t *self, uint64_t key, void const *data)
+{
+    // NOTE: SplitMix64 finalizer, so that sequential keys spread evenly across the lanes.
+    key ^= key >> 30;
+    key *= UINT64_C(0xbf58476d1ce4e5b9);
+    key ^= key >> 27;
+    key *= UINT64_C(0x94d049bb133111eb);
+    key ^= key >> 31;
+    struct g2l_lane *lane = &self->lanes[key % self->n_lanes];
+    struct g2l_node *node;
+    int error = g2l_node_create(&lane->list, data, &node);
+    if (error != 0)
+    {
+        return error;
+    }
+    pthread_mutex_lock(&lane->lock);
+    g2l_push_internal(&lane->list, node);
+    __atomic_store_n(&lane->n, lane->list.n, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&lane->lock);
+    return 0;
+}
+
+bool g2l_sharded_dequeue(g2l_sharded_t *self, void *data)
+{
+    return g2l_sharded_dequeue_batch(self, data, 1) == 1;
+}
+
+size_t g2l_sharded_dequeue_batch(g2l_sharded_t *self, void *data, size_t max)
+{
+    if (G2L_CHECK(self->data_size == 0 && data != NULL))
+    {
+        g2l_programming_error(__func__, __LINE__, "expecting 'data' argument to be NULL pointer for 'data_size = 0'");
+    }
+    size_t home = g2l_sharded_home_lane(self, &g2l_thread_consumer_lane, &g2l_next_consumer_lane);
+    size_t count = 0;
+    for (size_t i = 0; i < self->n_lanes && count < max; i++)
+    {
+        struct g2l_lane *lane = &self->lanes[(home + i) % self->n_lanes];
+        char *output = data == NULL ? NULL : (char *)data + count * self->data_size;
+        count += g2l_sharded_drain_lane(self, lane, output, max - count);
+    }
+    return count;
+}
+
+static void g2l_init(g2l_t *self, size_t data_size, bool abort_on_enomem)
+{
+    self->data_size = data_size;
+    self->abort_on_enomem = abort_on_enomem;
+    self->node_size = sizeof(struct g2l_node);
+    self->n = 0;
+    self->head = NULL;
+    self->tail = NULL;
+    self->ttl_mode = false;
+    self->ttl = 0;
+    self->finger = NULL;
+    self->finger_index = 0;
+    self->skip = NULL;
+    self->skip_state = (uint64_t)(uintptr_t)self | 1; // Any non-zero seed will do
+    self->compare = NULL;
+    self->rcu = NULL;
+}
+
+static int g2l_node_create(g2l_t *self, void const *data, struct g2l_node **output)
+{
+    if (G2L_CHECK(self->data_size == 0 && data != NULL))
+    {
+        g2l_programming_error(__func__, __LINE__, "'data' argument should be NULL when 'data_size = 0'");
+    }
+    if (G2L_CHECK(self->data_size > 0 && data == NULL))
+    {
+        g2l_programming_error(__func__, __LINE__, "'data' argument should not be NULL because 'data_size = %zu'", self->data_size);
+    }
+    struct g2l_node *node = malloc(self->node_size);
+    if (G2L_UNLIKELY(node == NULL))
+    {
+        g2l_enomem_error(self->abort_on_enomem);
+        return ENOMEM;
+    }
+    node->previous = NULL;
+    node->next = NULL;
+    node->data = NULL;
+    // NOTE: Kept out of line, so that this function stays small enough to be inlined for plain lists.
+    if (self->node_size != sizeof(struct g2l_node) && G2L_UNLIKELY(g2l_node_init_extended(self, node) != 0))
+    {
+        free(node);
+        return ENOMEM;
+    }
+    if (self->data_size > 0)
+    {
+        node->data = malloc(self->data_size);
+        if (G2L_UNLIKELY(node->data == NULL))
+        {
+            g2l_enomem_error(self->abort_on_enomem);
+            if (self->skip != NULL)
+            {
+                free(g2l_extended(node)->tower);
+            }
+            free(node);
+            return ENOMEM;
+        }
+        memcpy(node->data, data, self->data_size);
+    }
+    *output = node;
+    return 0;
+}
+
+static void g2l_push_internal(g2l_t *self, struct g2l_node *node)
+{
+    if (self->n == 0)
+    {
+        self->head = node;
+        G2L_PUBLISH(self->tail, node);
+    }
+    else
+    {
+        struct g2l_node *tmp = self->head;
+        node->next = tmp;
+        G2L_PUBLISH(tmp->previous, node);
+        self->head = node;
+    }
+    self->n += 1;
+    if (self->skip != NULL)
+    {
+        g2l_skip_insert(self, node, self->n - 1);
+    }
+}
+
+static struct g2l_node *g2l_pop_internal(g2l_t *self)
+{
+    if (G2L_UNLIKELY(self->n == 0))
+    {
+        g2l_library_error("g2l_pop_internal() should not be called for 'self->n = 0'");
+    }
+    struct g2l_node *tmp = self->head;
+    if (self->skip != NULL)
+    {
+        g2l_skip_remove(self, tmp, self->n - 1);
+    }
+    if (self->finger == tmp)
+    {
+        self->finger = NULL;
+    }
+    self->head = tmp->next;
+    if (self->head != NULL)
+    {
+        G2L_PUBLISH(self->head->previous, NULL);
+    }
+    self->n -= 1;
+    if (self->n == 0)
+    {
+        G2L_PUBLISH(self->tail, NULL);
+    }
+    return tmp;
+}
+
+static struct g2l_node *g2l_shift_internal(g2l_t *self)
+{
+    if (G2L_UNLIKELY(self->n == 0))
+    {
+        g2l_library_error("g2l_shift_internal() should not be called for 'self->n = 0'");
+    }
+    struct g2l_node *tmp = self->tail;
+    if (self->skip != NULL)
+    {
+        g2l_skip_remove(self, tmp, 0);
+    }
+    if (self->finger == tmp)
+    {
+        self->finger = NULL;
+    }
+    else if (self->finger != NULL)
+    {
+        self->finger_index -= 1;
+    }
+    G2L_PUBLISH(self->tail, tmp->previous);
+    if (self->tail != NULL)
+    {
+        self->tail->next = NULL;
+    }
+    self->n -= 1;
+    if (self->n == 0)
+    {
+        self->head = NULL;
+    }
+    return tmp;
+}
+
+static void g2l_node_free(g2l_t *self, struct g2l_node *node)
+{
+    if (self->rcu == NULL)
+    {
+        // NOTE: The node is freed before its data (i.e., in the reverse order of their allocation
+        // by `g2l_node_create`), so that the allocator hands them back in the same order.
+        void *data = node->data;
+        if (self->skip != NULL)
+        {
+            free(g2l_extended(node)->tower);
+        }
+        free(node);
+        free(data);
+        return;
+    }
+    // NOTE: Concurrent readers may still be traversing `node`, so it is only retired here.
+    struct g2l_rcu *rcu = self->rcu;
+    g2l_extended(node)->timestamp = rcu->epoch;
+    node->next = NULL;
+    if (rcu->retired_tail == NULL)
+    {
+        rcu->retired_head = node;
+    }
+    else
+    {
+        rcu->retired_tail->next = node;
+    }
+    rcu->retired_tail = node;
+    rcu->n_retired += 1;
+    if (rcu->n_retired >= G2L_RECLAIM_THRESHOLD)
+    {
+        g2l_reclaim(self);
+    }
+}
+
+static void g2l_link_at(g2l_t *self, struct g2l_node *node, size_t index)
+{
+    if (index == self->n)
+    {
+        g2l_push_internal(self, node);
+        return;
+    }
+    g2l_link_before(self, node, g2l_node_at(self, index), index);
+}
+
+// Links `node` between `younger` (currently at `index`) and the node at `index - 1` (if any).
+static void g2l_link_before(g2l_t *self, struct g2l_node *node, struct g2l_node *younger, size_t index)
+{
+    struct g2l_node *older = younger->next;
+    node->previous = younger;
+    node->next = older;
+    younger->next = node;
+    if (older == NULL)
+    {
+        G2L_PUBLISH(self->tail, node);
+    }
+    else
+    {
+        G2L_PUBLISH(older->previous, node);
+    }
+    self->n += 1;
+    if (self->skip != NULL)
+    {
+        g2l_skip_insert(self, node, index);
+    }
+    // NOTE: The finger may have been left on `younger`, which has moved to `index + 1`.
+    self->finger = node;
+    self->finger_index = index;
+}
+
+static void g2l_unlink(g2l_t *self, struct g2l_node *node, size_t index)
+{
+    if (self->skip != NULL)
+    {
+        g2l_skip_remove(self, node, index);
+    }
+    if (self->finger == node)
+    {
+        self->finger = NULL;
+    }
+    else if (self->finger != NULL && index < self->finger_index)
+    {
+        self->finger_index -= 1;
+    }
+    if (node->previous == NULL)
+    {
+        self->head = node->next;
+    }
+    else
+    {
+        node->previous->next = node->next;
+    }
+    if (node->next == NULL)
+    {
+        G2L_PUBLISH(self->tail, node->previous);
+    }
+    else
+    {
+        G2L_PUBLISH(node->next->previous, node->previous);
+    }
+    self->n -= 1;
+}
+
+static struct g2l_node *g2l_node_at(g2l_t *self, size_t index)
+{
+    // NOTE: Start from whichever of the tail, the head or the finger is closest.
+    struct g2l_node *node = self->tail;
+    size_t position = 0;
+    size_t distance = index;
+    if (self->n - 1 - index < distance)
+    {
+        node = self->head;
+        position = self->n - 1;
+        distance = self->n - 1 - index;
+    }
+    if (self->finger != NULL)
+    {
+        size_t tmp = index > self->finger_index ? index - self->finger_index : self->finger_index - index;
+        if (tmp < distance)
+        {
+            node = self->finger;
+            position = self->finger_index;
+            distance = tmp;
+        }
+    }
+    if (self->skip != NULL && distance > G2L_FINGER_MAX_WALK)
+    {
+        node = g2l_skip_find(self, index);
+    }
+    else
+    {
+        for (; position < index; position++)
+        {
+            node = node->previous;
+        }
+        for (; position > index; position--)
+        {
+            node = node->next;
+        }
+    }
+    self->finger = node;
+    self->finger_index = index;
+    return node;
+}
+
+static size_t g2l_skip_random_levels(g2l_t *self)
+{
+    // NOTE: xorshift64, then each pair of bits gives a 1/4 chance to grow the tower by one level.
+    uint64_t x = self->skip_state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    self->skip_state = x;
+    size_t levels = 0;
+    while ((x & 3) == 0 && levels < G2L_SKIP_MAX_LEVEL)
+    {
+        levels += 1;
+        x >>= 2;
+    }
+    return levels;
+}
+
+// Finds, for each level, the last tower whose position is at most `index` (positions
+// being 1-based, with the header at position 0), and stores that position in `rank`.
+static void g2l_skip_locate(g2l_t const *self, size_t index, struct g2l_skip_tower **update, size_t *rank)
+{
+    struct g2l_skip_tower *x = self->skip;
+    size_t position = 0;
+    for (size_t i = G2L_SKIP_MAX_LEVEL; i-- > 0;)
+    {
+        while (x->links[i].next != NULL && position + x->links[i].width <= index)
+        {
+            position += x->links[i].width;
+            x = x->links[i].next;
+        }
+        update[i] = x;
+        rank[i] = position;
+    }
+}
+
+// Must be called after `node` has been linked into the list at `index`.
+static void g2l_skip_insert(g2l_t *self, struct g2l_node *node, size_t index)
+{
+    struct g2l_skip_tower *update[G2L_SKIP_MAX_LEVEL];
+    size_t rank[G2L_SKIP_MAX_LEVEL];
+    g2l_skip_locate(self, index, update, rank);
+    struct g2l_skip_tower *tower = g2l_extended(node)->tower;
+    size_t position = index + 1;
+    for (size_t i = 0; i < G2L_SKIP_MAX_LEVEL; i++)
+    {
+        struct g2l_skip_link *link = &update[i]->links[i];
+        if (tower != NULL && i < tower->levels)
+        {
+            tower->links[i].next = link->next;
+            tower->links[i].back = update[i];
+            tower->links[i].width = link->next == NULL ? 0 : rank[i] + link->width + 1 - position;
+            if (link->next != NULL)
+            {
+                link->next->links[i].back = tower;
+            }
+            link->next = tower;
+            link->width = position - rank[i];
+        }
+        else if (link->next != NULL)
+        {
+            link->width += 1;
+        }
+    }
+}
+
+// Must be called while `node` is still at `index` (i.e., before unlinking it).
+static void g2l_skip_remove(g2l_t *self, struct g2l_node *node, size_t index)
+{
+    struct g2l_skip_tower *tower = g2l_extended(node)->tower;
+    if (index + 1 == self->n)
+    {
+        // NOTE: No link spans past the last element, so only the levels of its own tower
+        // (if any) need to be updated, which makes `g2l_pop` as cheap as `g2l_shift`.
+        for (size_t i = 0; tower != NULL && i < tower->levels; i++)
+        {
+            tower->links[i].back->links[i].next = NULL;
+            tower->links[i].back->links[i].width = 0;
+        }
+        free(tower);
+        g2l_extended(node)->tower = NULL;
+        return;
+    }
+    struct g2l_skip_tower *update[G2L_SKIP_MAX_LEVEL];
+    size_t rank[G2L_SKIP_MAX_LEVEL];
+    g2l_skip_locate(self, index, update, rank);
+    for (size_t i = 0; i < G2L_SKIP_MAX_LEVEL; i++)
+    {
+        struct g2l_skip_link *link = &update[i]->links[i];
+        if (tower != NULL && i < tower->levels)
+        {
+            link->width = tower->links[i].next == NULL ? 0 : link->width + tower->links[i].width - 1;
+            link->next = tower->links[i].next;
+            if (link->next != NULL)
+            {
+                link->next->links[i].back = update[i];
+            }
+        }
+        else if (link->next != NULL)
+        {
+            link->width -= 1;
+        }
+    }
+    free(tower);
+    g2l_extended(node)->tower = NULL;
+}
+
+static struct g2l_node *g2l_skip_find(g2l_t const *self, size_t index)
+{
+    struct g2l_skip_tower *update[G2L_SKIP_MAX_LEVEL];
+    size_t rank[G2L_SKIP_MAX_LEVEL];
+    g2l_skip_locate(self, index, update, rank);
+    // NOTE: The bottom level is the list itself; the tower at position `rank[0]`
+    // holds the node at index `rank[0] - 1`.
+    struct g2l_node *node = rank[0] == 0 ? self->tail : update[0]->node->previous;
+    for (size_t position = rank[0]; position < index; position++)
+    {
+        node = node->previous;
+    }
+    return node;
+}
+
+// Returns the index of the first element that is not less than `key` (or, if `upper`
+// is true, that is greater than `key`), and stores that element in `output` (NULL if
+// there is no such element).
+static size_t g2l_skip_bound(g2l_t const *self, void const *key, bool upper, struct g2l_node **output)
+{
+    struct g2l_skip_tower *x = self->skip;
+    size_t position = 0;
+    for (size_t i = G2L_SKIP_MAX_LEVEL; i-- > 0;)
+    {
+        struct g2l_skip_tower *next;
+        while ((next = x->links[i].next) != NULL)
+        {
+            int tmp = self->compare(next->node->data, key);
+            if (upper ? tmp > 0 : tmp >= 0)
+            {
+                break;
+            }
+            position += x->links[i].width;
+            x = next;
+        }
+    }
+    struct g2l_node *node = position == 0 ? self->tail : x->node->previous;
+    while (node != NULL)
+    {
+        int tmp = self->compare(node->data, key);
+        if (upper ? tmp > 0 : tmp >= 0)
+        {
+            break;
+        }
+        node = node->previous;
+        position += 1;
+    }
+    *output = node;
+    return position;
+}
+
+static inline struct g2l_extended_node *g2l_extended(struct g2l_node *node)
+{
+    return (struct g2l_extended_node *)node;
+}
+
+static int g2l_node_init_extended(g2l_t *self, struct g2l_node *node)
+{
+    struct g2l_extended_node *extended = g2l_extended(node);
+    if (self->ttl_mode)
+    {
+        extended->timestamp = g2l_now();
+    }
+    if (self->skip == NULL)
+    {
+        return 0; // NOTE: For concurrent lists, the retirement epoch is set by `g2l_node_free`.
+    }
+    extended->tower = NULL;
+    size_t levels = g2l_skip_random_levels(self);
+    if (levels == 0)
+    {
+        return 0;
+    }
+    struct g2l_skip_tower *tower = malloc(sizeof(struct g2l_skip_tower) + levels * sizeof(struct g2l_skip_link));
+    if (G2L_UNLIKELY(tower == NULL))
+    {
+        g2l_enomem_error(self->abort_on_enomem);
+        return ENOMEM;
+    }
+    tower->node = node;
+    tower->levels = levels;
+    extended->tower = tower;
+    return 0;
+}
+
+static inline bool g2l_key_equals(void const *data, void const *key, size_t key_size)
+{
+    // NOTE: The fixed-width cases compile to a single load and compare, instead of a call to `memcmp`.
+    switch (key_size)
+    {
+    case sizeof(uint32_t):
+    {
+        uint32_t a, b;
+        memcpy(&a, data, sizeof(a));
+        memcpy(&b, key, sizeof(b));
+        return a == b;
+    }
+    case sizeof(uint64_t):
+    {
+        uint64_t a, b;
+        memcpy(&a, data, sizeof(a));
+        memcpy(&b, key, sizeof(b));
+        return a == b;
+    }
+    default:
+        return memcmp(data, key, key_size) == 0;
+    }
+}
+
+// Returns the first node, starting at `node` and walking toward the youngest element,
+// whose data starts with `key`, after having added the number of skipped nodes to `index`.
+static struct g2l_node *g2l_scan_key(struct g2l_node *node, size_t *index, void const *key, size_t key_size)
+{
+    struct g2l_node *batch[G2L_SCAN_BATCH];
+    while (node != NULL)
+    {
+        // NOTE: A batch of nodes is gathered first, with their data being prefetched along
+        // the way, so that the data cache misses overlap with the pointer chase instead of
+        // each comparison waiting for its own miss.
+        size_t count = 0;
+        for (; node != NULL && count < G2L_SCAN_BATCH; node = node->previous)
+        {
+            G2L_PREFETCH(node->data);
+            batch[count++] = node;
+        }
+        for (size_t i = 0; i < count; i++)
+        {
+            if (g2l_key_equals(batch[i]->data, key, key_size))
+            {
+                *index += i;
+                return batch[i];
+            }
+        }
+        *index += count;
+    }
+    return NULL;
+}
+
+static inline void g2l_assert_key_size(g2l_t const *self, size_t key_size, char const *func)
+{
+    if (G2L_CHECK(key_size == 0 || key_size > self->data_size))
+    {
+        g2l_programming_error(func, __LINE__, "expecting '0 < key_size <= data_size' but 'key_size = %zu' and 'data_size = %zu'", key_size, self->data_size);
+    }
+}
+
+static inline void g2l_assert_not_sorted(g2l_t const *self, char const *func)
+{
+    if (G2L_CHECK(self->compare != NULL))
+    {
+        g2l_programming_error(func, __LINE__, "list was created using 'g2l_create_sorted' (use 'g2l_insert_sorted' instead)");
+    }
+}
+
+static inline void g2l_assert_sorted(g2l_t const *self, char const *func)
+{
+    if (G2L_CHECK(self->compare == NULL))
+    {
+        g2l_programming_error(func, __LINE__, "list was not created using 'g2l_create_sorted'");
+    }
+}
+
+static inline void g2l_assert_concurrent(g2l_t const *self, char const *func)
+{
+    if (G2L_CHECK(self->rcu == NULL))
+    {
+        g2l_programming_error(func, __LINE__, "list was not created using 'g2l_create_concurrent'");
+    }
+}
+
+static inline void g2l_assert_ttl_mode(g2l_t const *self, char const *func)
+{
+    if (G2L_CHECK(!self->ttl_mode))
+    {
+        g2l_programming_error(func, __LINE__, "list was not created using 'g2l_create_ttl'");
+    }
+}
+
+static size_t g2l_sharded_home_lane(g2l_sharded_t const *self, size_t *thread_lane, size_t *next_lane)
+{
+    if (*thread_lane == SIZE_MAX)
+    {
+        *thread_lane = __atomic_fetch_add(next_lane, 1, __ATOMIC_RELAXED);
+    }
+    return *thread_lane % self->n_lanes;
+}
+
+static size_t g2l_sharded_drain_lane(g2l_sharded_t *self, struct g2l_lane *lane, char *data, size_t max)
+{
+    // NOTE: Peeking at the mirrored size avoids taking the locks of empty lanes.
+    if (__atomic_load_n(&lane->n, __ATOMIC_RELAXED) == 0)
+    {
+        return 0;
+    }
+    size_t count = 0;
+    pthread_mutex_lock(&lane->lock);
+    while (count < max && lane->list.n > 0)
+    {
+        struct g2l_node *tmp = g2l_shift_internal(&lane->list);
+        if (data != NULL)
+        {
+            memcpy(data + count * self->data_size, tmp->data, self->data_size);
+        }
+        g2l_node_free(&lane->list, tmp);
+        count += 1;
+    }
+    __atomic_store_n(&lane->n, lane->list.n, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&lane->lock);
+    return count;
+}
+
+static void g2l_programming_error(char const *func, int line, char const *format, ...)
+{
+    fprintf(stderr, "[file:%s][line:%i] %s %s ", G2L_SRC_FILE_NAME, line, func, PROGRAMMING_ERROR_PREFIX);
+    va_list args;
+    va_start(args, format);
+    vfprintf(stderr, format, args);
+    va_end(args);
+    fprintf(stderr, "\n");
+    abort();
+}
+
+static void g2l_library_error(char const *format, ...)
+{
+    fprintf(stderr, "%s ", LIBRARY_ERROR_PREFIX);
+    va_list args;
+    va_start(args, format);
+    vfprintf(stderr, format, args);
+    va_end(args);
+    fprintf(stderr, "\n");
+    abort();
+}
+
+static void g2l_enomem_error(bool abort_on_enomem)
+{
+    if (abort_on_enomem)
+    {
+        perror("malloc()");
+        abort();
+    }
+    if (errno != ENOMEM) // Based on my understanding, this should not be possible.
+    {
+        g2l_library_error("Oups... Expecting errno to contain '%s' but contains '%s'", strerror(ENOMEM), strerror(errno));
+    }
+}
+
+#ifdef G2L_HEADER_ONLY
+// NOTE: In header-only mode, this file ends up in the application's translation unit,
+// so the private macros are removed to keep them from clashing with the application's.
+#undef G2L_SRC_FILE_NAME
+#undef LIBRARY_ERROR_PREFIX
+#undef PROGRAMMING_ERROR_PREFIX
+#undef G2L_PREFETCH
+#undef G2L_PUBLISH
+#undef G2L_LOAD
+#undef G2L_LIKELY
+#undef G2L_UNLIKELY
+#undef G2L_COLD
+#undef G2L_NOINLINE
+#undef G2L_CHECK
+#endif